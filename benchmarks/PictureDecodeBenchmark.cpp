@@ -0,0 +1,87 @@
+//================================================================================================
+/// @file PictureDecodeBenchmark.cpp
+///
+/// @brief Compares the picture graphic pixel expansion kernels against a plain per-pixel loop
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#include "PictureDecodeKernels.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/// @brief The per-pixel loop the picture decoder used before the kernels existed
+static void expand_per_pixel(const std::uint8_t *source, std::uint32_t *destination, std::size_t pixelCount, const std::uint32_t *colourTable)
+{
+	for (std::size_t i = 0; i < pixelCount; i++)
+	{
+		destination[i] = colourTable[source[i]];
+	}
+}
+
+template<typename Kernel>
+static double time_kernel(Kernel kernel, const std::vector<std::uint8_t> &source, std::vector<std::uint32_t> &destination, std::size_t width, const std::uint32_t *colourTable, int iterations)
+{
+	const std::size_t height = source.size() / width;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		for (std::size_t row = 0; row < height; row++)
+		{
+			kernel(source.data() + (row * width), destination.data() + (row * width), width, colourTable);
+		}
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / iterations;
+}
+
+int main()
+{
+	constexpr int ITERATIONS = 200;
+	const std::size_t sizes[][2] = { { 80, 80 }, { 480, 480 }, { 800, 600 }, { 1024, 768 } };
+
+	std::uint32_t colourTable[256];
+	std::mt19937 generator(11783);
+	for (auto &colour : colourTable)
+	{
+		colour = generator();
+	}
+
+	std::printf("Vectorized kernel available: %s\n", is_vectorized_pixel_expansion_available() ? "yes" : "no");
+	std::printf("%-12s %14s %14s %14s %9s\n", "size", "per-pixel ms", "scalar ms", "dispatch ms", "speedup");
+
+	int retVal = 0;
+	for (const auto &size : sizes)
+	{
+		const std::size_t width = size[0];
+		const std::size_t height = size[1];
+		std::vector<std::uint8_t> source(width * height);
+		std::vector<std::uint32_t> reference(width * height);
+		std::vector<std::uint32_t> destination(width * height);
+
+		for (auto &index : source)
+		{
+			index = static_cast<std::uint8_t>(generator());
+		}
+
+		const double perPixel = time_kernel(expand_per_pixel, source, reference, width, colourTable, ITERATIONS);
+		const double scalar = time_kernel(expand_indexed_pixels_scalar, source, destination, width, colourTable, ITERATIONS);
+		const double dispatched = time_kernel(expand_indexed_pixels, source, destination, width, colourTable, ITERATIONS);
+
+		if (0 != std::memcmp(reference.data(), destination.data(), reference.size() * sizeof(std::uint32_t)))
+		{
+			std::printf("Output mismatch at %zux%zu\n", width, height);
+			retVal = 1;
+		}
+
+		char sizeText[32];
+		std::snprintf(sizeText, sizeof(sizeText), "%zux%zu", width, height);
+		std::printf("%-12s %14.4f %14.4f %14.4f %8.2fx\n", sizeText, perPixel, scalar, dispatched, perPixel / dispatched);
+	}
+	return retVal;
+}
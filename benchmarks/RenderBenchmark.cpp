@@ -0,0 +1,219 @@
+//================================================================================================
+/// @file RenderBenchmark.cpp
+///
+/// @brief Parses every object pool in a corpus directory and renders each of its data masks offscreen,
+/// printing one CSV row per mask so results can be compared between releases.
+/// @details Usage: RenderBenchmark <corpus directory> [steady state paints per mask]
+/// The corpus can contain raw .iop files and the .iopx files the server stores pools in.
+/// Times are in microseconds, and peak memory is the peak resident set size of the process
+/// in kilobytes at the time the row was written.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#if defined(_WIN32)
+// Keep windows.h from declaring names like Rectangle that clash with JUCE
+#define NOGDI
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "JuceHeader.h"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "MaskRasterizer.hpp"
+
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/// @brief How many bytes of version label the server puts in front of the object pool in .iopx files
+static constexpr std::size_t IOPX_LABEL_LENGTH = 7;
+
+/// @brief The most time a pool may take to parse before it is reported as failed
+static constexpr std::chrono::seconds PARSE_TIMEOUT(60);
+
+/// @brief Returns the time since a start point in microseconds
+static std::int64_t get_elapsed_us(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// @brief Returns the peak resident set size of this process in kilobytes
+static std::int64_t get_peak_memory_kb()
+{
+	std::int64_t retVal = 0;
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		retVal = static_cast<std::int64_t>(counters.PeakWorkingSetSize / 1024);
+	}
+#else
+	struct rusage usage;
+
+	if (0 == getrusage(RUSAGE_SELF, &usage))
+	{
+#if defined(__APPLE__)
+		retVal = static_cast<std::int64_t>(usage.ru_maxrss / 1024); // macOS reports bytes
+#else
+		retVal = static_cast<std::int64_t>(usage.ru_maxrss);
+#endif
+	}
+#endif
+	return retVal;
+}
+
+/// @brief Parses an object pool the same way the server does, on the working set's parsing thread
+/// @param[in] workingSet The working set to parse into
+/// @param[in] objectPool The raw object pool
+/// @returns true if the pool parsed successfully
+static bool parse_object_pool(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::vector<std::uint8_t> &objectPool)
+{
+	const auto start = std::chrono::steady_clock::now();
+	bool retVal = false;
+
+	workingSet->add_iop_raw_data(objectPool);
+	workingSet->start_parsing_thread();
+
+	while (std::chrono::steady_clock::now() - start < PARSE_TIMEOUT)
+	{
+		auto state = workingSet->get_object_pool_processing_state();
+
+		if ((isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Success == state) ||
+		    (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Fail == state))
+		{
+			retVal = (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Success == state);
+			workingSet->join_parsing_thread();
+			break;
+		}
+		std::this_thread::yield();
+	}
+	return retVal;
+}
+
+int main(int argc, char *argv[])
+{
+	int retVal = 0;
+
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <corpus directory> [steady state paints per mask]\n", argv[0]);
+		retVal = 1;
+	}
+	else
+	{
+		// Components and fonts need the message manager even though nothing is shown
+		ScopedJuceInitialiser_GUI juceInitialiser;
+		const File corpusDirectory = File::getCurrentWorkingDirectory().getChildFile(String(argv[1]));
+		const int steadyStatePaints = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 20;
+		auto corpusFiles = corpusDirectory.findChildFiles(File::TypesOfFileToFind::findFiles, true, "*.iop;*.iopx");
+
+		corpusFiles.sort();
+		std::printf("pool,status,mask_id,width,height,parse_us,predecode_us,picture_bytes,build_us,first_paint_us,steady_mean_us,steady_min_us,steady_max_us,peak_memory_kb\n");
+
+		if (corpusFiles.isEmpty())
+		{
+			std::fprintf(stderr, "No .iop or .iopx files found in %s\n", corpusDirectory.getFullPathName().toRawUTF8());
+			retVal = 1;
+		}
+
+		for (const auto &file : corpusFiles)
+		{
+			MemoryBlock fileData;
+			file.loadFileAsData(fileData);
+
+			const std::size_t skippedBytes = (file.hasFileExtension("iopx") ? IOPX_LABEL_LENGTH : 0);
+			const auto poolName = file.getRelativePathFrom(corpusDirectory).replaceCharacter(',', '_');
+			std::vector<std::uint8_t> objectPool;
+
+			if (fileData.getSize() > skippedBytes)
+			{
+				auto fileBytes = static_cast<const std::uint8_t *>(fileData.getData());
+				objectPool.assign(fileBytes + skippedBytes, fileBytes + fileData.getSize());
+			}
+
+			auto workingSet = std::make_shared<isobus::VirtualTerminalServerManagedWorkingSet>();
+			auto start = std::chrono::steady_clock::now();
+
+			if (objectPool.empty() || (!parse_object_pool(workingSet, objectPool)))
+			{
+				std::printf("%s,parse_failed,,,,%lld,,,,,,,,%lld\n", poolName.toRawUTF8(), static_cast<long long>(get_elapsed_us(start)), static_cast<long long>(get_peak_memory_kb()));
+				retVal = 1;
+				continue;
+			}
+			const auto parse_us = get_elapsed_us(start);
+
+			start = std::chrono::steady_clock::now();
+			JuceManagedWorkingSetCache::predecode_pictures(workingSet);
+			const auto predecode_us = get_elapsed_us(start);
+			const auto pictureBytes = JuceManagedWorkingSetCache::get_decoded_picture_memory_usage(workingSet);
+
+			for (const auto &object : workingSet->get_object_tree())
+			{
+				if ((nullptr == object.second) || (isobus::VirtualTerminalObjectType::DataMask != object.second->get_object_type()))
+				{
+					continue;
+				}
+
+				start = std::chrono::steady_clock::now();
+				auto component = JuceManagedWorkingSetCache::create_component(workingSet, object.second);
+				const auto build_us = get_elapsed_us(start);
+
+				if (nullptr == component)
+				{
+					std::printf("%s,build_failed,%u,,,%lld,%lld,%zu,%lld,,,,,%lld\n", poolName.toRawUTF8(), static_cast<unsigned>(object.first), static_cast<long long>(parse_us), static_cast<long long>(predecode_us), pictureBytes, static_cast<long long>(build_us), static_cast<long long>(get_peak_memory_kb()));
+					retVal = 1;
+					continue;
+				}
+
+				// The first paint includes anything components create lazily, such as font glyphs
+				start = std::chrono::steady_clock::now();
+				auto image = MaskRasterizer::render_to_image(workingSet, object.first);
+				const auto firstPaint_us = get_elapsed_us(start);
+
+				std::int64_t steadyTotal_us = 0;
+				std::int64_t steadyMin_us = 0;
+				std::int64_t steadyMax_us = 0;
+
+				for (int i = 0; i < steadyStatePaints; i++)
+				{
+					start = std::chrono::steady_clock::now();
+					image = MaskRasterizer::render_to_image(workingSet, object.first);
+					const auto paint_us = get_elapsed_us(start);
+
+					steadyTotal_us += paint_us;
+					steadyMin_us = (0 == i) ? paint_us : std::min(steadyMin_us, paint_us);
+					steadyMax_us = std::max(steadyMax_us, paint_us);
+				}
+
+				std::printf("%s,ok,%u,%d,%d,%lld,%lld,%zu,%lld,%lld,%lld,%lld,%lld,%lld\n",
+				            poolName.toRawUTF8(),
+				            static_cast<unsigned>(object.first),
+				            component->getWidth(),
+				            component->getHeight(),
+				            static_cast<long long>(parse_us),
+				            static_cast<long long>(predecode_us),
+				            pictureBytes,
+				            static_cast<long long>(build_us),
+				            static_cast<long long>(firstPaint_us),
+				            static_cast<long long>(steadyTotal_us / steadyStatePaints),
+				            static_cast<long long>(steadyMin_us),
+				            static_cast<long long>(steadyMax_us),
+				            static_cast<long long>(get_peak_memory_kb()));
+			}
+			JuceManagedWorkingSetCache::remove_working_set(workingSet);
+		}
+	}
+	return retVal;
+}
@@ -0,0 +1,163 @@
+//================================================================================================
+/// @file StringEncodingBenchmark.cpp
+///
+/// @brief Measures converting a corpus of typical object pool strings to UTF-8, against the per-byte
+/// table walk that was used before printable ASCII was copied straight through
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#include "StringEncodingConversions.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/// @brief Appends one UTF-16 character as UTF-8, as the converter did before the ASCII fast path
+static void add_character_per_byte(std::uint16_t character, std::string &output)
+{
+	if (character < 0x80)
+	{
+		output.push_back(static_cast<char>(character));
+	}
+	else if (character < 0x800)
+	{
+		output.push_back(static_cast<char>(0xC0 | (character >> 6)));
+		output.push_back(static_cast<char>(0x80 | (character & 0x3F)));
+	}
+	else if (character < 0xFFFF)
+	{
+		output.push_back(static_cast<char>(0xE0 | (character >> 12)));
+		output.push_back(static_cast<char>(0x80 | ((character >> 6) & 0x3F)));
+		output.push_back(static_cast<char>(0x80 | (character & 0x3F)));
+	}
+}
+
+/// @brief The per-byte table walk the converter used before the ASCII fast path existed
+static void convert_per_byte(const std::uint16_t *table, const std::string &input, std::string &output, bool autoWrappingEnabled)
+{
+	output.reserve(input.size());
+
+	for (const unsigned char encodedChar : input)
+	{
+		std::uint16_t newCharacter = table[encodedChar];
+
+		if (((encodedChar >= 0x7F) && (encodedChar <= 0xA0)) ||
+		    ((encodedChar < 0x20) && (0x0A != encodedChar) && (0x0D != encodedChar)))
+		{
+			// Unsupported control characters take up no room
+		}
+		else if (0xAD == encodedChar) // Soft Hyphen wraps in ISO 11783
+		{
+			if (autoWrappingEnabled)
+			{
+				add_character_per_byte(newCharacter, output);
+				add_character_per_byte(table[0x0A], output);
+			}
+		}
+		else
+		{
+			add_character_per_byte(newCharacter, output);
+		}
+	}
+}
+
+/// @brief Builds a corpus that looks like the strings of a real pool: mostly short ASCII labels and units,
+/// some longer help texts, and a few strings with accented characters and soft hyphens.
+static std::vector<std::string> build_corpus()
+{
+	const char *labels[] = { "Speed", "km/h", "Section 1", "Section 12", "Boom height", "Rate", "l/ha", "Tank level", "Auto", "Manual", "OK", "Cancel", "Work state", "Application rate", "Target rate", "Prescription map loaded" };
+	const char *helpTexts[] = { "Press and hold the button to fold the boom. Release the button to stop folding.", "The tank is nearly empty. Refill the tank before continuing the application." };
+	const char *highBytes[] = { "\xD6lstand", "Dr\xFC"
+	                                        "cken",
+		                          "Gr\xF6\xDF"
+		                          "e",
+		                          "Temp. \xB0"
+		                          "C",
+		                          "Spr\xFC\xAD"
+		                          "hbalken" };
+	std::mt19937 generator(11783);
+	std::vector<std::string> retVal;
+
+	for (int i = 0; i < 2000; i++)
+	{
+		auto choice = generator() % 20;
+
+		if (choice < 16)
+		{
+			retVal.emplace_back(labels[generator() % (sizeof(labels) / sizeof(labels[0]))]);
+		}
+		else if (choice < 18)
+		{
+			retVal.emplace_back(helpTexts[generator() % (sizeof(helpTexts) / sizeof(helpTexts[0]))]);
+		}
+		else
+		{
+			retVal.emplace_back(highBytes[generator() % (sizeof(highBytes) / sizeof(highBytes[0]))]);
+		}
+	}
+	return retVal;
+}
+
+int main()
+{
+	constexpr int ITERATIONS = 500;
+	const auto corpus = build_corpus();
+	std::size_t corpusBytes = 0;
+
+	for (const auto &input : corpus)
+	{
+		corpusBytes += input.size();
+	}
+
+	// The corpus is all ISO 8859-1, which maps every byte to the code point with the same value
+	std::uint16_t iso8859_1Table[256];
+	for (std::uint16_t i = 0; i < 256; i++)
+	{
+		iso8859_1Table[i] = i;
+	}
+
+	std::vector<std::string> perByteResults(corpus.size());
+	auto start = std::chrono::steady_clock::now();
+	for (int iteration = 0; iteration < ITERATIONS; iteration++)
+	{
+		for (std::size_t i = 0; i < corpus.size(); i++)
+		{
+			perByteResults[i].clear();
+			convert_per_byte(iso8859_1Table, corpus[i], perByteResults[i], true);
+		}
+	}
+	const std::chrono::duration<double, std::milli> perByteTime = std::chrono::steady_clock::now() - start;
+
+	std::vector<std::string> singleResults(corpus.size());
+	start = std::chrono::steady_clock::now();
+	for (int iteration = 0; iteration < ITERATIONS; iteration++)
+	{
+		for (std::size_t i = 0; i < corpus.size(); i++)
+		{
+			singleResults[i].clear();
+			convert_string_to_utf_8(SourceEncoding::ISO8859_1, corpus[i], singleResults[i], true);
+		}
+	}
+	const std::chrono::duration<double, std::milli> singleTime = std::chrono::steady_clock::now() - start;
+
+	int retVal = 0;
+	for (std::size_t i = 0; i < corpus.size(); i++)
+	{
+		if (perByteResults[i] != singleResults[i])
+		{
+			std::printf("Fast path output differs from the per-byte conversion for string %zu\n", i);
+			retVal = 1;
+			break;
+		}
+	}
+
+	const double megabytes = static_cast<double>(corpusBytes) * ITERATIONS / (1024.0 * 1024.0);
+	std::printf("Corpus: %zu strings, %zu bytes\n", corpus.size(), corpusBytes);
+	std::printf("%-28s %10.3f ms/pool %10.1f MiB/s\n", "per-byte table walk", perByteTime.count() / ITERATIONS, megabytes / (perByteTime.count() / 1000.0));
+	std::printf("%-28s %10.3f ms/pool %10.1f MiB/s\n", "convert_string_to_utf_8", singleTime.count() / ITERATIONS, megabytes / (singleTime.count() / 1000.0));
+	std::printf("ASCII fast path speedup: %.2fx\n", perByteTime.count() / singleTime.count());
+	return retVal;
+}
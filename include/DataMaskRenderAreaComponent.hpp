@@ -12,7 +12,9 @@
 #include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
+#include "HitTestIndex.hpp"
 #include "JuceHeader.h"
+#include "ObjectChangeTracker.hpp"
 
 class ServerMainComponent;
 
@@ -25,6 +27,13 @@ public:
 
 	void on_working_set_disconnect(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
 
+	/// @brief Drops the click lookup if any of the changed objects could have moved or replaced something clickable,
+	/// and works out again which parts of the mask are hidden behind opaque objects.
+	/// @details Call this after the changes have been applied to the component cache.
+	/// @param[in] workingSet The working set whose objects changed
+	/// @param[in] changes The objects that changed
+	void on_objects_changed(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const ObjectChangeTracker::ChangeSet &changes);
+
 	void paint(Graphics &g) override;
 
 	// Used to calculate button press events
@@ -33,8 +42,6 @@ public:
 	// Used to calculate button release events
 	void mouseUp(const MouseEvent &event) override;
 
-	bool needsRepaint() const;
-
 	void set_has_started(bool started);
 
 private:
@@ -55,9 +62,15 @@ private:
 		std::uint32_t lastValue = 0;
 	};
 
-	std::shared_ptr<isobus::VTObject> getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y);
-	static bool objectCanBeClicked(std::shared_ptr<isobus::VTObject> object);
-	static bool isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight);
+	std::shared_ptr<isobus::VTObject> getClickedObject(std::shared_ptr<isobus::VTObject> activeMask, int x, int y);
+
+	/// @brief Marks containers and object pointers as opaque when an opaque child covers all of them.
+	/// @details JUCE skips painting anything fully covered by an opaque sibling above it, but only looks one level deep.
+	/// Passing opacity up through the objects that don't draw anything themselves lets it also skip content hidden
+	/// behind a stack of overlapping containers, like tab pages.
+	/// @param[in] component The top of the tree to update
+	/// @returns true if the component is opaque after the update
+	static bool update_occlusion(Component &component);
 
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
 	std::unique_ptr<AlertWindow> inputListModal;
@@ -68,7 +81,7 @@ private:
 	std::vector<std::shared_ptr<Component>> currentModalComponentCache;
 	ServerMainComponent &ownerServer;
 	InputNumberListener inputNumberListener;
-	bool needToRepaintActiveArea = false;
+	HitTestIndex hitTestIndex;
 	bool hasStarted = false;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DataMaskRenderAreaComponent)
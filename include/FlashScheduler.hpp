@@ -0,0 +1,58 @@
+//================================================================================================
+/// @file FlashScheduler.hpp
+///
+/// @brief A single clock that drives the flashing of every flashing object, so they flash in sync.
+/// @details The clock is deleted when JUCE shuts down, along with its timer. Components that
+/// unsubscribe after that, such as ones still held in a cache, are simply ignored.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef FLASH_SCHEDULER_HPP
+#define FLASH_SCHEDULER_HPP
+
+#include "JuceHeader.h"
+
+#include <set>
+
+class FlashScheduler : private Timer
+  , private DeletedAtShutdown
+{
+public:
+	/// @brief How long each phase of a flash lasts
+	static constexpr int FLASH_PHASE_MS = 500;
+
+	/// @brief Adds a component to be repainted each time the flash phase changes.
+	/// @details The clock only runs while at least one component is subscribed.
+	/// Subscribing a component that is already subscribed does nothing.
+	/// @param[in] component The flashing component
+	static void subscribe(Component *component);
+
+	/// @brief Stops repainting a component when the flash phase changes.
+	/// @details Components must unsubscribe before they are destroyed.
+	/// @param[in] component The component to stop repainting
+	static void unsubscribe(Component *component);
+
+	/// @brief Returns if a component is currently subscribed to the flash clock
+	/// @param[in] component The component to check
+	/// @returns true if the component is repainted each flash phase, otherwise false
+	static bool is_subscribed(const Component *component);
+
+	/// @brief Returns which half of the flash period we are in
+	/// @returns true while flashing objects should be drawn normally, false while they should be hidden or inverted
+	static bool is_shown();
+
+	JUCE_DECLARE_SINGLETON_SINGLETHREADED(FlashScheduler, true)
+
+private:
+	FlashScheduler() = default;
+	~FlashScheduler() override;
+
+	/// @brief Toggles the phase and repaints the area covering all subscribers, once per top level window
+	void timerCallback() override;
+
+	std::set<Component *> subscribers; ///< The components to repaint each phase
+	bool shown = true; ///< The current flash phase
+};
+
+#endif // FLASH_SCHEDULER_HPP
@@ -0,0 +1,81 @@
+//================================================================================================
+/// @file HitTestIndex.hpp
+///
+/// @brief A flattened, grid bucketed lookup of the clickable objects in a mask.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef HIT_TEST_INDEX_HPP
+#define HIT_TEST_INDEX_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include <set>
+#include <vector>
+
+class HitTestIndex
+{
+public:
+	/// @brief Flattens the clickable objects under a mask into absolute rectangles, replacing any previous contents.
+	/// @details Objects are walked in the same order a recursive search of the mask would, following object pointers, so
+	/// when clickable objects overlap, the one the recursive search would find first still wins.
+	/// @param[in] workingSet The working set that owns the mask
+	/// @param[in] rootObject The mask to index
+	void build(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> rootObject);
+
+	/// @brief Empties the index, so that it gets rebuilt before it's next used
+	void clear();
+
+	/// @brief Returns if the index currently holds the objects of a specific mask
+	/// @param[in] rootObjectID The ID of the mask
+	/// @returns true if the index was built for the mask and hasn't been cleared since
+	bool is_built_for(std::uint16_t rootObjectID) const;
+
+	/// @brief Returns if the contents of the index depend on an object's position, size, children or pointer value
+	/// @param[in] objectID The ID of the object to check
+	/// @returns true if a change to the object may move, add or remove a clickable area
+	bool depends_on(std::uint16_t objectID) const;
+
+	/// @brief Returns the clickable object at a point
+	/// @param[in] x The x position relative to the mask
+	/// @param[in] y The y position relative to the mask
+	/// @returns The ID of the object, or NULL_OBJECT_ID if nothing clickable is there
+	std::uint16_t find_object(int x, int y) const;
+
+	/// @brief Returns if an object is one that can be clicked on to interact with it
+	/// @param[in] object The object to check
+	/// @returns true if the object reacts to being clicked, otherwise false
+	static bool can_be_clicked(std::shared_ptr<isobus::VTObject> object);
+
+private:
+	/// @brief An object's clickable area in mask coordinates. Edges are inclusive, as the recursive search used them.
+	struct Entry
+	{
+		int left; ///< The left edge
+		int top; ///< The top edge
+		int right; ///< The right edge
+		int bottom; ///< The bottom edge
+		std::uint16_t objectID; ///< The object that was clicked if the point is within the area
+	};
+
+	static constexpr int MIN_CELL_SIZE = 32; ///< The smallest width and height of a grid cell in pixels
+	static constexpr int MAX_GRID_DIMENSION = 64; ///< The most rows or columns the grid will have
+
+	void add_children(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> object, int x, int y);
+	void add_entry(std::shared_ptr<isobus::VTObject> object, int x, int y);
+
+	std::vector<Entry> entries; ///< The clickable areas in search order
+	std::vector<std::vector<std::uint32_t>> cells; ///< For each grid cell, the indices of the entries that overlap it, in search order
+	std::set<std::uint16_t> dependencies; ///< Objects whose changes invalidate the index
+	int gridLeft = 0; ///< The x position of the first grid column
+	int gridTop = 0; ///< The y position of the first grid row
+	int gridColumns = 0; ///< The number of grid columns
+	int gridRows = 0; ///< The number of grid rows
+	int cellSize = MIN_CELL_SIZE; ///< The width and height of each grid cell in pixels
+	std::uint16_t rootObjectID = isobus::NULL_OBJECT_ID; ///< The mask the index was built for
+	bool built = false; ///< Whether the index holds anything
+};
+
+#endif // HIT_TEST_INDEX_HPP
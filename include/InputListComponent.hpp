@@ -13,6 +13,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "ResolvedReference.hpp"
 
 class InputListComponent : public isobus::InputList
   , public Component
@@ -27,6 +28,7 @@ public:
 
 private:
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
+	ResolvedReference<isobus::NumberVariable> numberVariable; ///< The number variable that holds the selected index
 	std::shared_ptr<Component> childComponent;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InputListComponent)
@@ -13,14 +13,143 @@
 #include "JuceHeader.h"
 #include "SoftKeyMaskComponent.hpp"
 
+#include <array>
+#include <map>
+#include <set>
+#include <tuple>
+
 class JuceManagedWorkingSetCache
 {
 public:
+	/// @brief A working set's 256 colour palette, packed the way JUCE stores ARGB image pixels
+	using PackedColourTable = std::array<PixelARGB, 256>;
+
+	/// @brief A font attributes object resolved into what's needed to draw text with it
+	struct ResolvedFont
+	{
+		Font font; ///< The monospaced font at the object's size, with bold, italic and underline applied
+		Font plainFont; ///< The same font without any style applied, as used for numbers
+		Colour colour; ///< The font colour
+		isobus::FontAttributes::FontType type = isobus::FontAttributes::FontType::ISO8859_1; ///< The string encoding of the font
+		std::uint8_t widthPixels = 0; ///< The width of one character in pixels
+		bool inverted = false; ///< Whether the text should be drawn with the foreground and background colours swapped
+		bool flashing = false; ///< Whether the text flashes between normal and inverted
+		bool flashingHidden = false; ///< Whether the text flashes between shown and hidden
+	};
+
+	/// @brief Returns a component that draws the specified object.
+	/// @details Components are cached per working set and object ID, so asking for an object that was
+	/// drawn before (for example when switching back to a previously shown mask) returns the existing
+	/// component and its already built children. A cached component is only handed out if it is not
+	/// currently part of a tree that is on screen, otherwise another instance is built and cached.
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] sourceObject The object to get a component for
+	/// @returns A component for the object, or nullptr if the object type is not drawable
 	static std::shared_ptr<Component> create_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> sourceObject);
 
+	/// @brief Drops the cached components of an object that was changed, so they get rebuilt the next time they are requested.
+	/// @details Components hold a copy of their object, so the cached components that contain the
+	/// changed object (its parents, up to the mask) are dropped as well, along with any components whose
+	/// layout depends on the object, such as an input list that selects its item with a number variable.
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] objectID The ID of the object that changed
+	static void invalidate_object(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID);
+
+	/// @brief Brings the cached components of a changed object up to date, and repaints the components that reference it.
+	/// @details Components that only draw their own object's attributes (strings, numbers, shapes, meters and such)
+	/// are updated in place. Anything else, like a component that builds children from its object, is invalidated
+	/// the same way as invalidate_object.
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] objectID The ID of the object that changed
+	/// @returns True if the change was fully applied in place, false if a component tree that is on screen needs to be rebuilt
+	static bool update_object(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID);
+
+	/// @brief Drops all cached components, fonts and decoded pictures for a working set, for when we can't tell which objects changed
+	/// @param[in] workingSet The working set to drop components for
+	static void invalidate_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Marks a working set's packed colour table as outdated, for when its colour map or colour palette may have changed
+	/// @param[in] workingSet The working set whose colours changed
+	static void invalidate_colours(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Removes a working set from the cache entirely, such as when it disconnects
+	/// @param[in] workingSet The working set to forget
+	static void remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Removes every working set from the cache, destroying all cached components.
+	/// @details Call this before JUCE shuts down, since the cache is static and would otherwise destroy its components after JUCE is gone.
+	static void clear();
+
+	/// @brief Returns a number that changes whenever an object may have changed, for components that cache things derived from it.
+	/// @details The revision advances when the object is updated or invalidated, and for every object when the whole working set is invalidated.
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] objectID The ID of the object to get the revision of
+	/// @returns The object's current revision
+	static std::uint32_t get_object_revision(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID);
+
+	/// @brief Returns a number that changes whenever the whole working set is invalidated, such as when a new object pool is loaded
+	/// @param[in] workingSet The working set to get the revision of
+	/// @returns The working set's current revision
+	static std::uint32_t get_working_set_revision(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Returns the font to draw text with for a font attributes object.
+	/// @details Fonts are cached per working set and rebuilt when the object's revision changes, such as
+	/// after a change font attributes command, or when the whole working set is invalidated.
+	/// @param[in] workingSet The working set that owns the font attributes
+	/// @param[in] fontAttributesID The ID of the font attributes object
+	/// @returns The resolved font, or nullptr if the ID isn't a font attributes object
+	static std::shared_ptr<const ResolvedFont> get_font(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t fontAttributesID);
+
+	/// @brief Returns the packed colour table for a working set, building it the first time it's needed.
+	/// @details The table is only rebuilt after invalidate_colours, such as when a colour map is selected or a new pool is loaded.
+	/// @param[in] workingSet The working set to get the colours of
+	/// @returns The working set's colours, indexed by VT colour index
+	static std::shared_ptr<const PackedColourTable> get_packed_colour_table(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Returns one colour from a working set's packed colour table.
+	/// @details Components should use this instead of converting the working set's floating point colours themselves.
+	/// @param[in] workingSet The working set to get the colour from
+	/// @param[in] colourIndex The VT colour index
+	/// @returns The opaque colour at that index
+	static Colour get_colour(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint8_t colourIndex);
+
+	/// @brief Returns the decoded image for a picture graphic at its displayed size.
+	/// @details Decoded images are shared by every component that shows the same picture at the same size,
+	/// so treat the returned image as read only. They are keyed by object ID, size and colour table
+	/// revision, and are kept until the picture changes, the colours change, the whole working set is
+	/// invalidated or the working set disconnects.
+	/// @param[in] workingSet The working set that owns the picture
+	/// @param[in] picture The picture graphic to get the image of
+	/// @returns The decoded and rescaled image
+	static Image get_decoded_picture(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::PictureGraphic &picture);
+
+	/// @brief Decodes every picture graphic in a working set's object pool ahead of time, so masks don't have to decode them when first shown.
+	/// @details Pictures are decoded in parallel on a small number of worker threads, and this waits for them to
+	/// finish before storing the results in the decoded picture cache. Every picture is decoded again and replaces
+	/// whatever the cache held before, since those images may have come from an older copy of the pool.
+	/// Call it from the message thread once the object pool has been parsed.
+	/// @param[in] workingSet The working set whose pictures should be decoded
+	static void predecode_pictures(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Returns how much memory the decoded pictures of a working set are using
+	/// @param[in] workingSet The working set to check
+	/// @returns The number of bytes of pixel data in the working set's decoded picture cache
+	static std::size_t get_decoded_picture_memory_usage(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Draws the parts of a component tree that never change from cached images.
+	/// @details Each largest subtree that has child components, and where nothing reads a variable, flashes, takes
+	/// user input or has been changed by a command, is buffered to an image with setBufferedToImage. Any other
+	/// buffering in the tree is removed. Changing an object later removes the buffering around its components.
+	/// @param[in] workingSet The working set that owns the components
+	/// @param[in] root The top of the component tree, usually a data or alarm mask
+	static void update_static_layers(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, Component &root);
+
 	static void set_softkey_mask_dimension_info(const SoftKeyMaskDimensions &info);
 
 private:
+	/// @brief Object ID, width, height and colour table revision of a decoded picture
+	using DecodedPictureKey = std::tuple<std::uint16_t, int, int, std::uint32_t>;
+
 	class ComponentCacheClass
 	{
 	public:
@@ -28,9 +157,44 @@ private:
 		  workingSet(associatedWorkingSet){};
 
 		std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet;
-		//std::map<std::uint16_t, std::shared_ptr<Component>> componentLookup;
+		std::map<std::uint16_t, std::vector<std::shared_ptr<Component>>> componentLookup; ///< All cached component instances for each object ID
+		std::map<std::uint16_t, std::set<std::uint16_t>> dependentObjects; ///< Maps an object ID to the objects whose components must be rebuilt when it changes
+		std::map<std::uint16_t, std::vector<Component *>> referencingComponents; ///< Maps an object ID to the cached components that read it while painting
+		std::map<std::uint16_t, std::uint32_t> objectRevisions; ///< The revision each object was last changed at
+		std::uint32_t revisionCounter = 0; ///< The most recently handed out revision
+		std::uint32_t workingSetRevision = 0; ///< The revision the whole working set was last invalidated at
+		std::map<std::uint16_t, std::pair<std::uint32_t, std::shared_ptr<const ResolvedFont>>> resolvedFonts; ///< Fonts by font attributes ID, along with the revision they were built at
+		std::shared_ptr<const PackedColourTable> packedColourTable; ///< The working set's colours, built on first use
+		std::map<DecodedPictureKey, Image> decodedPictures; ///< Decoded picture graphics shared between components
+		std::size_t decodedPictureMemory = 0; ///< Bytes of pixel data held in decodedPictures
+		std::uint32_t colourTableRevision = 0; ///< Incremented each time the colour table's contents change
+		bool colourTableOutdated = false; ///< Set when the colours may have changed, to check the table on next use
+		std::set<std::uint16_t> volatileObjects; ///< Objects that have been changed by a command, which are never drawn from a static layer
 	};
+
+	static ComponentCacheClass &get_cache(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+	static std::shared_ptr<Component> build_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> sourceObject);
+	static bool is_component_available(const Component *component);
+	static bool is_component_in_use(const Component *component);
+	static bool update_component_in_place(ComponentCacheClass &cache, Component &component, std::shared_ptr<isobus::VTObject> sourceObject);
+	static std::vector<std::uint16_t> get_referenced_objects(const isobus::VTObject &object);
+	static void add_references(ComponentCacheClass &cache, Component *component);
+	static void remove_references(ComponentCacheClass &cache, const Component *component);
+	static void erase_component_and_parents(ComponentCacheClass &cache, Component *component);
+	static void erase_component(ComponentCacheClass &cache, const Component *component);
+	static void erase_decoded_pictures(ComponentCacheClass &cache, std::uint16_t objectID);
+	static void update_packed_colour_table(ComponentCacheClass &cache);
+	static void update_opacity(Component &component);
+	static void demote_static_layers(ComponentCacheClass &cache, std::uint16_t objectID);
+	static bool is_static_component(const ComponentCacheClass &cache, const Component &component);
+	static bool find_static_layers(const ComponentCacheClass &cache, Component &component, std::set<const Component *> &layers);
+	static void apply_static_layers(Component &component, const std::set<const Component *> &layers);
+
+	static constexpr std::size_t MAX_PICTURE_DECODE_THREADS = 4; ///< The most worker threads predecode_pictures will use
+
 	static std::vector<ComponentCacheClass> workingSetComponentCache;
+	static std::set<const Component *> componentsHandedOutThisBuild; ///< Components that were already used while building the current component tree
+	static std::uint32_t buildDepth; ///< How many create_component calls are currently nested
 
 	static SoftKeyMaskDimensions softKeyDimensionInfo;
 	static int dataAndAlarmMaskSize;
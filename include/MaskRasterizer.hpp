@@ -0,0 +1,56 @@
+//================================================================================================
+/// @file MaskRasterizer.hpp
+///
+/// @brief Draws masks into memory without a window, for render benchmarks, image comparisons and remote displays.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef MASK_RASTERIZER_HPP
+#define MASK_RASTERIZER_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include "JuceHeader.h"
+
+#include <vector>
+
+class MaskRasterizer
+{
+public:
+	/// @brief A rendered image as tightly packed 8-bit RGBA pixels, row by row from the top left, with straight (not premultiplied) alpha
+	struct RGBAImage
+	{
+		std::vector<std::uint8_t> pixels; ///< width * height * 4 bytes of pixel data
+		int width = 0; ///< The width of the image in pixels
+		int height = 0; ///< The height of the image in pixels
+	};
+
+	/// @brief Draws an object, usually a data, alarm or soft key mask, into a software image.
+	/// @details The object is drawn by the same components that draw it on screen, taken from the component cache,
+	/// but painted straight into memory, so no window, peer or display is needed. A JUCE message manager is still
+	/// required (such as from a ScopedJuceInitialiser_GUI), and this must be called from its thread.
+	/// Flashing objects are drawn in the current flash phase.
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] objectID The ID of the object to draw
+	/// @param[in] scale How many image pixels to use per VT pixel
+	/// @returns The rendered image, or a null image if the object doesn't exist or can't be drawn
+	static Image render_to_image(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID, float scale = 1.0f);
+
+	/// @brief Draws an object the same way as render_to_image, and returns the result as an RGBA buffer.
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] objectID The ID of the object to draw
+	/// @param[in] scale How many image pixels to use per VT pixel
+	/// @returns The rendered pixels, which are empty if the object doesn't exist or can't be drawn
+	static RGBAImage render_to_rgba(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID, float scale = 1.0f);
+
+	/// @brief Converts an image into tightly packed RGBA pixels with straight alpha
+	/// @param[in] image The image to convert
+	/// @returns The converted pixels
+	static RGBAImage convert_to_rgba(const Image &image);
+
+private:
+	MaskRasterizer() = default;
+};
+
+#endif // MASK_RASTERIZER_HPP
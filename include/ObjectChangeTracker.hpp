@@ -0,0 +1,87 @@
+//================================================================================================
+/// @file ObjectChangeTracker.hpp
+///
+/// @brief Keeps track of which VT objects each client has changed with ECU to VT commands,
+/// so that only the affected components need to be rebuilt.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef OBJECT_CHANGE_TRACKER_HPP
+#define OBJECT_CHANGE_TRACKER_HPP
+
+#include "isobus/isobus/can_control_function.hpp"
+#include "isobus/isobus/can_message.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_base.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+class ObjectChangeTracker
+{
+public:
+	/// @brief The objects a client has changed since its changes were last taken
+	struct ChangeSet
+	{
+		std::set<std::uint16_t> changedObjects; ///< IDs of the objects that were changed
+		bool fullRefreshNeeded = false; ///< True if something changed that can't be narrowed down to specific objects
+		bool coloursChanged = false; ///< True if the colour map or colour palette may have changed
+		std::uint32_t repaintRequests = 0; ///< How many repaint requests from the VT server these changes were gathered from
+	};
+
+	ObjectChangeTracker() = default;
+
+	/// @brief Inspects an ECU to VT message and records which object it changes
+	/// @details This needs to be called before the VT server processes the message so that the changed objects
+	/// are known by the time the server's repaint event fires. Changes stay pending until that event, since
+	/// the object has not actually been modified before then.
+	/// @param[in] message The ECU to VT message to inspect
+	void process_ecu_to_vt_message(const isobus::CANMessage &message);
+
+	/// @brief Call this when the VT server requests a repaint for a client.
+	/// This makes the pending changes for the client available to take_changes. If no command was recorded
+	/// for the client since the last repaint, something we can't see changed the pool (like a macro executed
+	/// from the GUI), so a full refresh is flagged.
+	/// @param[in] client The client whose working set needs repainting
+	void on_repaint_requested(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief Flags that everything in a client's pool should be treated as changed
+	/// @param[in] client The client to flag
+	void request_full_refresh(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief Returns if a client has changes waiting to be taken
+	/// @param[in] client The client to check
+	/// @returns true if take_changes would return something for the client
+	bool has_changes(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief Returns and clears the changes that have been applied to a client's objects
+	/// @param[in] client The client to get changes for
+	/// @returns The changes that were applied since the last call for this client
+	ChangeSet take_changes(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief Discards everything recorded for a client, such as when it disconnects
+	/// @param[in] client The client to forget
+	void remove_client(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief A CAN callback that forwards ECU to VT messages to a tracker
+	/// @param[in] message The received message
+	/// @param[in] parentPointer A pointer to the ObjectChangeTracker
+	static void process_rx_message(const isobus::CANMessage &message, void *parentPointer);
+
+private:
+	using Function = isobus::VirtualTerminalBase::Function; ///< The VT function codes, as the VT server decodes them
+
+	/// @brief Everything recorded for one client
+	struct ClientChanges
+	{
+		ChangeSet pending; ///< Changes from commands the VT server may not have processed yet
+		ChangeSet ready; ///< Changes the VT server has processed, waiting to be taken
+	};
+
+	std::map<std::shared_ptr<isobus::ControlFunction>, ClientChanges> clientChanges; ///< Changes for each client
+	std::mutex changesMutex; ///< Protects clientChanges, since messages arrive on the CAN thread
+};
+
+#endif // OBJECT_CHANGE_TRACKER_HPP
@@ -13,6 +13,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "ResolvedReference.hpp"
 
 class OutputEllipseComponent : public isobus::OutputEllipse
   , public Component
@@ -23,8 +24,33 @@ public:
 	void paint(Graphics &g) override;
 
 private:
+	/// @brief Everything the arc's path depends on, so the path can be reused until one of them changes
+	struct ArcKey
+	{
+		std::uint16_t width = 0; ///< The width of the ellipse
+		std::uint16_t height = 0; ///< The height of the ellipse
+		std::uint8_t startAngle = 0; ///< The start angle, in VT units of 2 degrees
+		std::uint8_t endAngle = 0; ///< The end angle, in VT units of 2 degrees
+		EllipseType type = EllipseType::Closed; ///< Whether the arc is open, a segment or a section
+		std::uint16_t lineWidth = 0; ///< The width of the outline
+
+		bool operator==(const ArcKey &other) const;
+	};
+
+	static constexpr float MAX_ARC_ERROR = 0.25f; ///< The furthest in pixels a straight piece of an arc may stray from the true curve
+
+	/// @brief Rebuilds the cached arc path and its stroked outline from the current attributes
+	/// @param[in] lineWidth The width of the outline
+	void update_arc(std::uint16_t lineWidth);
+
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
-	void addArcToPath(Path &path, float x, float y, float w, float h, float fromRadians, float toRadians, bool startAsNewSubPath) const;
+	ResolvedReference<isobus::FillAttributes> fillAttributes; ///< The fill attributes object
+	ResolvedReference<isobus::LineAttributes> lineAttributes; ///< The line attributes object
+	ArcKey arcKey; ///< What the cached arc was built from
+	Path arcPath; ///< The cached arc, including any lines to the centre or between the end points
+	Path arcOutline; ///< The cached arc path, stroked with the line width
+	bool arcValid = false; ///< Whether the arc cache has been filled in
+	static void addArcToPath(Path &path, float x, float y, float w, float h, float fromRadians, float toRadians, bool startAsNewSubPath);
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputEllipseComponent)
 };
 
@@ -13,6 +13,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "ResolvedReference.hpp"
 
 class OutputLinearBarGraphComponent : public isobus::OutputLinearBarGraph
   , public Component
@@ -24,6 +25,7 @@ public:
 
 private:
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
+	ResolvedReference<isobus::NumberVariable> numberVariable; ///< The number variable that holds the value
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputLinearBarGraphComponent)
 };
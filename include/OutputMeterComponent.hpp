@@ -13,6 +13,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "ResolvedReference.hpp"
 
 class OutputMeterComponent : public isobus::OutputMeter
   , public Component
@@ -23,7 +24,46 @@ public:
 	void paint(Graphics &g) override;
 
 private:
+	/// @brief Everything the dial depends on, so the dial image can be reused until one of them changes
+	struct DialKey
+	{
+		std::uint16_t width = 0; ///< The width of the meter
+		std::uint16_t height = 0; ///< The height of the meter
+		std::uint8_t startAngle = 0; ///< The start angle, in VT units of 2 degrees
+		std::uint8_t endAngle = 0; ///< The end angle, in VT units of 2 degrees
+		std::uint8_t numberOfTicks = 0; ///< How many tick marks are drawn along the arc
+		bool drawArc = false; ///< Whether the arc is drawn
+		bool drawBorder = false; ///< Whether the border is drawn
+		bool drawTicks = false; ///< Whether the tick marks are drawn
+		Colour borderColour; ///< The colour of the border
+		Colour arcAndTickColour; ///< The colour of the arc and tick marks
+		float scale = 1.0f; ///< How many physical pixels the dial image has per logical pixel
+
+		bool operator==(const DialKey &other) const;
+	};
+
+	/// @brief Returns the meter's start angle and how far anticlockwise the meter range extends from it
+	/// @param[out] startDegrees The start angle in degrees, anticlockwise from the positive X axis
+	/// @param[out] sweepDegrees The angle from the start angle to the end angle in degrees
+	void get_range_angles(float &startDegrees, float &sweepDegrees) const;
+
+	/// @brief Returns the point on the dial at a given angle and fraction of the radius
+	/// @param[in] degrees The angle in degrees, anticlockwise from the positive X axis
+	/// @param[in] radiusFraction How far from the centre to the edge of the dial the point should be
+	/// @returns The point, in component coordinates
+	Point<float> get_point_on_dial(float degrees, float radiusFraction) const;
+
+	/// @brief Draws the parts of the meter that don't depend on its value into the dial image
+	void render_dial();
+
+	static constexpr float TICK_LENGTH = 0.15f; ///< The length of a tick mark, as a fraction of the radius
+	static constexpr float TICK_THICKNESS = 2.0f; ///< The thickness of a tick mark in pixels
+	static constexpr float NEEDLE_THICKNESS = 3.0f; ///< The thickness of the needle in pixels
+
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
+	ResolvedReference<isobus::NumberVariable> numberVariable; ///< The number variable that holds the value
+	DialKey dialKey; ///< What the cached dial image was drawn from
+	Image dialImage; ///< The border, arc and tick marks, drawn once and reused until the key changes
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputMeterComponent)
 };
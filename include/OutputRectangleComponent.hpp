@@ -13,6 +13,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "ResolvedReference.hpp"
 
 class OutputRectangleComponent : public isobus::OutputRectangle
   , public Component
@@ -22,8 +23,14 @@ public:
 
 	void paint(Graphics &g) override;
 
+	/// @brief Works out if the rectangle's fill covers all of it, from its fill and line attributes.
+	/// @details Call this after the rectangle or its attributes change, so JUCE can skip painting what's underneath.
+	void update_opacity();
+
 private:
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
+	ResolvedReference<isobus::FillAttributes> fillAttributes; ///< The fill attributes object
+	ResolvedReference<isobus::LineAttributes> lineAttributes; ///< The line attributes object
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputRectangleComponent)
 };
@@ -13,34 +13,56 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "JuceManagedWorkingSetCache.hpp"
 
 class OutputStringComponent : public isobus::OutputString
   , public Component
-  , private juce::Timer
 {
 public:
 	OutputStringComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::OutputString sourceObject);
 
+	~OutputStringComponent() override;
+
 	void paint(Graphics &g) override;
 
 	static Justification convert_justification(HorizontalJustification horizontalJustification, VerticalJustification verticalJustification);
 
 	void visibilityChanged() override;
 
-	void timerCallback() override;
+	/// @brief Works out if the string's background covers all of it, from its options and font attributes.
+	/// @details Call this after the string or its font attributes change, so JUCE can skip painting what's underneath.
+	void update_opacity();
 
 private:
+	/// @brief Everything the laid out text depends on, so the layout can be reused until one of them changes
+	struct LayoutKey
+	{
+		std::string rawValue; ///< The displayed value, as sent by the working set
+		std::uint32_t objectRevision = 0; ///< The revision of this output string's own attributes
+		std::uint32_t fontRevision = 0; ///< The revision of the font attributes object
+		int width = 0; ///< The width the text was fitted into
+		int height = 0; ///< The height the text was fitted into
+
+		bool operator==(const LayoutKey &other) const;
+	};
+
+	/// @brief Decodes the value and fits it into the component with the given font, storing the result in the layout cache
+	/// @param[in] value The displayed value, with anything after a NULL already removed
+	/// @param[in] font The font to lay the text out with, or nullptr to use the default font
+	/// @param[in] defaultFont The font to use when there are no font attributes
+	void update_layout(std::string value, std::shared_ptr<const JuceManagedWorkingSetCache::ResolvedFont> font, const Font &defaultFont);
+
 	/**
    * @brief isFlashing
    * @return true if the OutputString font attribute has any of the flashing mode set, false otherwise
    */
 	bool isFlashing() const;
 	bool visible = false;
-	/**
-   * @brief show - a boolean idicating that the string needs to be drawn based on the flashing state
-   */
-	bool show = true;
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
+	LayoutKey layoutKey; ///< What the cached layout was built from
+	String decodedValue; ///< The cached value, converted to UTF-8
+	GlyphArrangement layout; ///< The cached glyphs of decodedValue, fitted into the component
+	bool layoutValid = false; ///< Whether the layout cache has been filled in
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputStringComponent)
 };
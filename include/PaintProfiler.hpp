@@ -0,0 +1,121 @@
+//================================================================================================
+/// @file PaintProfiler.hpp
+///
+/// @brief Optional measurements of how long each kind of VT object and each working set takes to paint.
+/// @details The measurements are only taken when the project is built with ENABLE_PAINT_PROFILING,
+/// otherwise PAINT_PROFILER_SCOPE compiles to nothing.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef PAINT_PROFILER_HPP
+#define PAINT_PROFILER_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include "JuceHeader.h"
+
+#include <array>
+#include <chrono>
+#include <map>
+
+#ifdef AGISOVT_PAINT_PROFILING
+/// @brief Measures the rest of the enclosing paint function as one paint of a VT object
+#define PAINT_PROFILER_SCOPE(objectType, workingSet) const PaintProfiler::ScopedPaintTimer paintProfilerScopedTimer(objectType, workingSet)
+#else
+#define PAINT_PROFILER_SCOPE(objectType, workingSet)
+#endif
+
+class PaintProfiler
+{
+public:
+	/// @brief The number of histogram buckets. Bucket i counts paints that took from 2^i up to 2^(i+1) microseconds,
+	/// except the first also counts anything faster and the last also counts anything slower.
+	static constexpr std::size_t NUMBER_OF_BUCKETS = 16;
+
+	/// @brief A histogram of paint durations
+	struct Histogram
+	{
+		/// @brief Adds one duration to the histogram
+		/// @param[in] duration_us The duration in microseconds
+		void add(std::uint32_t duration_us);
+
+		/// @brief Returns an estimate of a percentile of the durations
+		/// @param[in] percentile The percentile to get, from 0 to 100
+		/// @returns The upper edge of the bucket the percentile falls in, in microseconds
+		std::uint32_t get_percentile(std::uint32_t percentile) const;
+
+		std::array<std::uint32_t, NUMBER_OF_BUCKETS> buckets = {}; ///< The number of durations in each bucket
+		std::uint64_t total_us = 0; ///< The sum of all durations
+		std::uint32_t count = 0; ///< The number of durations
+		std::uint32_t max_us = 0; ///< The longest duration
+	};
+
+	/// @brief Times a paint from construction to destruction, use PAINT_PROFILER_SCOPE rather than this directly
+	class ScopedPaintTimer
+	{
+	public:
+		/// @brief Starts timing a paint
+		/// @param[in] objectType The type of the object being painted
+		/// @param[in] workingSet The working set that owns the object
+		ScopedPaintTimer(isobus::VirtualTerminalObjectType objectType, const std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> &workingSet);
+
+		/// @brief Stops timing and records the duration
+		~ScopedPaintTimer();
+
+	private:
+		std::chrono::steady_clock::time_point startTime; ///< When the paint started
+		isobus::VirtualTerminalServerManagedWorkingSet *workingSet; ///< The working set that owns the object
+		isobus::VirtualTerminalObjectType objectType; ///< The type of the object being painted
+	};
+
+	/// @brief Returns if this build was made with paint profiling
+	/// @returns true if paints are being measured
+	static constexpr bool is_enabled()
+	{
+#ifdef AGISOVT_PAINT_PROFILING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/// @brief Adds the paints measured since the last call as one frame. Call this after each paint of the top level component.
+	static void end_frame();
+
+	/// @brief Discards everything measured so far
+	static void reset();
+
+	/// @brief Returns a short human readable summary of the slowest object types and the frame times, for the debug overlay
+	/// @param[in] maximumRows The most object types to list
+	/// @returns The summary, one line per entry
+	static String get_summary(std::size_t maximumRows);
+
+	/// @brief Writes every histogram to a CSV file
+	/// @param[in] file The file to write, which is replaced if it exists
+	/// @returns true if the file was written, otherwise false
+	static bool write_report(const File &file);
+
+private:
+	PaintProfiler() = default;
+
+	/// @brief Records one paint
+	/// @param[in] objectType The type of the object that was painted
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] duration_us How long the paint took in microseconds
+	static void record_paint(isobus::VirtualTerminalObjectType objectType, isobus::VirtualTerminalServerManagedWorkingSet *workingSet, std::uint32_t duration_us);
+
+	/// @brief Returns a readable name for a VT object type
+	/// @param[in] objectType The type to name
+	/// @returns The name of the type
+	static String get_object_type_name(isobus::VirtualTerminalObjectType objectType);
+
+	static std::map<isobus::VirtualTerminalObjectType, Histogram> objectTypePaints; ///< Paint durations by object type
+	static std::map<std::uint64_t, Histogram> workingSetPaints; ///< Paint durations by the full NAME of each working set's client
+	static Histogram frames; ///< The total paint duration of each frame
+	static std::uint32_t currentFrame_us; ///< The total paint duration of the frame in progress
+	static bool currentFrameHasPaints; ///< If anything was painted in the frame in progress
+};
+
+#endif // PAINT_PROFILER_HPP
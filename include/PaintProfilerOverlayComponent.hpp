@@ -0,0 +1,36 @@
+//================================================================================================
+/// @file PaintProfilerOverlayComponent.hpp
+///
+/// @brief A debug overlay that shows the paint profiler's summary on top of the masks.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef PAINT_PROFILER_OVERLAY_COMPONENT_HPP
+#define PAINT_PROFILER_OVERLAY_COMPONENT_HPP
+
+#include "JuceHeader.h"
+
+class PaintProfilerOverlayComponent : public Component
+  , private Timer
+{
+public:
+	PaintProfilerOverlayComponent();
+
+	void paint(Graphics &g) override;
+
+	/// @brief Starts refreshing the summary while shown, and stops when hidden
+	void visibilityChanged() override;
+
+private:
+	void timerCallback() override;
+
+	static constexpr int REFRESH_INTERVAL_MS = 500; ///< How often the summary is refreshed while shown
+	static constexpr std::size_t MAXIMUM_ROWS = 8; ///< How many object types are listed
+
+	String summary; ///< The summary text as of the last refresh
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PaintProfilerOverlayComponent)
+};
+
+#endif // PAINT_PROFILER_OVERLAY_COMPONENT_HPP
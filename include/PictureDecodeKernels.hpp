@@ -0,0 +1,34 @@
+//================================================================================================
+/// @file PictureDecodeKernels.hpp
+///
+/// @brief Helper functions for expanding picture graphic colour indices into packed pixels
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef PICTURE_DECODE_KERNELS_HPP
+#define PICTURE_DECODE_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Expands a run of 8-bit colour indices into packed 32-bit pixels through a 256 entry colour table.
+/// @details Uses an AVX2 gather when the CPU supports it, otherwise falls back to a scalar loop.
+/// @param[in] source The colour indices to expand
+/// @param[in] destination The buffer to write pixelCount pixels to
+/// @param[in] pixelCount The number of pixels to expand
+/// @param[in] colourTable The 256 packed pixels to look the indices up in
+void expand_indexed_pixels(const std::uint8_t *source, std::uint32_t *destination, std::size_t pixelCount, const std::uint32_t *colourTable);
+
+/// @brief Expands a run of 8-bit colour indices using only the scalar loop
+/// @param[in] source The colour indices to expand
+/// @param[in] destination The buffer to write pixelCount pixels to
+/// @param[in] pixelCount The number of pixels to expand
+/// @param[in] colourTable The 256 packed pixels to look the indices up in
+void expand_indexed_pixels_scalar(const std::uint8_t *source, std::uint32_t *destination, std::size_t pixelCount, const std::uint32_t *colourTable);
+
+/// @brief Returns if expand_indexed_pixels will use the vectorized kernel on this CPU
+/// @returns true if the AVX2 kernel is available, otherwise false
+bool is_vectorized_pixel_expansion_available();
+
+#endif // PICTURE_DECODE_KERNELS_HPP
@@ -13,27 +13,30 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "JuceManagedWorkingSetCache.hpp"
 
 class PictureGraphicComponent : public isobus::PictureGraphic
   , public Component
-  , private juce::Timer
 {
 public:
 	PictureGraphicComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::PictureGraphic sourceObject);
 
-	void generate_and_store_image();
+	~PictureGraphicComponent() override;
+
+	/// @brief Decodes a picture graphic's raw data into an image at the picture's displayed size
+	/// @param[in] picture The picture graphic to decode
+	/// @param[in] colourTable The colours of the working set that owns the picture
+	/// @returns The decoded image
+	static Image decode_image(isobus::PictureGraphic &picture, const JuceManagedWorkingSetCache::PackedColourTable &colourTable);
 
 	void paint(Graphics &g) override;
 
 	void visibilityChanged() override;
 
-	void timerCallback() override;
-
 private:
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
 	Image reconstructedImage;
 	bool visible = false;
-	bool showImage = true;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PictureGraphicComponent)
 };
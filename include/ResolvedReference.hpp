@@ -0,0 +1,61 @@
+//================================================================================================
+/// @file ResolvedReference.hpp
+///
+/// @brief A cached handle to an object that a component refers to by ID, like its fill attributes or variable.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef RESOLVED_REFERENCE_HPP
+#define RESOLVED_REFERENCE_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include "JuceManagedWorkingSetCache.hpp"
+
+/// @brief Remembers which object an ID resolved to, so paint doesn't have to search the object tree every frame.
+/// @details The object is looked up again when the ID changes, such as after a change attribute command
+/// updates the component's copy of its object, or when the working set's cache is invalidated, such as
+/// when a new object pool is loaded.
+template<typename ObjectType>
+class ResolvedReference
+{
+public:
+	/// @brief Returns the referenced object
+	/// @param[in] workingSet The working set that owns the object
+	/// @param[in] objectID The ID being referenced
+	/// @param[in] expectedType The type the object must have
+	/// @returns The object, or nullptr if the ID is null, missing, or the wrong type
+	ObjectType *get(const std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> &workingSet, std::uint16_t objectID, isobus::VirtualTerminalObjectType expectedType)
+	{
+		const auto workingSetRevision = JuceManagedWorkingSetCache::get_working_set_revision(workingSet);
+
+		if ((!resolved) || (objectID != resolvedObjectID) || (workingSetRevision != resolvedRevision))
+		{
+			object.reset();
+
+			if ((nullptr != workingSet) && (isobus::NULL_OBJECT_ID != objectID))
+			{
+				auto candidate = workingSet->get_object_by_id(objectID);
+
+				if ((nullptr != candidate) && (expectedType == candidate->get_object_type()))
+				{
+					object = std::static_pointer_cast<ObjectType>(candidate);
+				}
+			}
+			resolvedObjectID = objectID;
+			resolvedRevision = workingSetRevision;
+			resolved = true;
+		}
+		return object.get();
+	}
+
+private:
+	std::shared_ptr<ObjectType> object; ///< The resolved object, held so it stays valid even if the pool replaces it
+	std::uint32_t resolvedRevision = 0; ///< The working set revision the object was resolved at
+	std::uint16_t resolvedObjectID = isobus::NULL_OBJECT_ID; ///< The ID the object was resolved from
+	bool resolved = false; ///< Whether the reference has been resolved yet
+};
+
+#endif // RESOLVED_REFERENCE_HPP
@@ -3,20 +3,26 @@
 #include "ConfigureHardwareWindow.hpp"
 #include "DataMaskRenderAreaComponent.hpp"
 #include "LoggerComponent.hpp"
+#include "ObjectChangeTracker.hpp"
+#include "PaintProfilerOverlayComponent.hpp"
 #include "SoftKeyMaskComponent.hpp"
 #include "SoftKeyMaskRenderAreaComponent.hpp"
+#include "StoredVersionCatalog.hpp"
+#include "UpdateRateGovernor.hpp"
 #include "VT_NumberComponent.hpp"
 #include "WorkingSetSelectorComponent.hpp"
 #include "isobus/isobus/isobus_diagnostic_protocol.hpp"
 #include "isobus/isobus/isobus_time_date_interface.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_server.hpp"
 
+#include <atomic>
 #include <filesystem>
 
 class ServerMainComponent : public juce::Component
   , public juce::KeyListener
   , public isobus::VirtualTerminalServer
   , public Timer
+  , public AsyncUpdater
   , public ApplicationCommandTarget
   , public MenuBarModel
 {
@@ -95,9 +101,17 @@ public:
 	/// @returns True if the client's active object pool was deactivated and removed from volatile storage, otherwise false.
 	bool delete_object_pool(isobus::NAME clientNAME) override;
 
+	/// @brief Handles everything that has to be checked periodically, like pool loading, held buttons and the status message.
+	/// @details This runs quickly while a pool is being transferred, parsed or loaded, or a button is held, and otherwise only
+	/// once per status message. Pool work that starts on the CAN thread wakes it early, see process_pool_activity_message.
 	void timerCallback() override;
 
+	/// @brief Attaches to the display refresh while mask updates are pending, and detaches once they're done.
+	/// Also speeds up the housekeeping timer when a client has started pool work.
+	void handleAsyncUpdate() override;
+
 	void paint(juce::Graphics &g) override;
+	void paintOverChildren(juce::Graphics &g) override;
 	void resized() override;
 
 	ApplicationCommandTarget *getNextCommandTarget() override;
@@ -115,6 +129,7 @@ public:
 	void set_button_held(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID, std::uint16_t maskObjectID, std::uint8_t keyCode, bool isSoftKey);
 	void set_button_released(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID, std::uint16_t maskObjectID, std::uint8_t keyCode, bool isSoftKey);
 
+	/// @brief Rebuilds the data and soft key masks on the next display refresh
 	void repaint_on_next_update();
 
 	void save_settings();
@@ -141,7 +156,9 @@ private:
 		ClearISOData,
 		ConfigureCANHardware,
 		StartStop,
-		AutoStart
+		AutoStart,
+		TogglePaintProfilerOverlay,
+		SavePaintProfile
 	};
 
 	SoftKeyMaskDimensions softKeyMaskDimensions;
@@ -176,11 +193,40 @@ private:
 
 	void on_change_active_mask_callback(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> affectedWorkingSet, std::uint16_t workingSet, std::uint16_t newMask);
 	void repaint_data_and_soft_key_mask();
+
+	/// @brief A CAN callback that wakes the housekeeping timer when a client starts a pool transfer or load,
+	/// so the response is sent as soon as the pool is parsed rather than at the next status message
+	/// @param[in] message The received ECU to VT message
+	/// @param[in] parentPointer A pointer to the ServerMainComponent
+	static void process_pool_activity_message(const isobus::CANMessage &message, void *parentPointer);
+
+	/// @brief Asks for pending object changes to be applied on the next display refresh. Safe to call from any thread.
+	void request_frame();
+
+	/// @brief Called on each display refresh while attached, to apply pending changes or detach if there aren't any
+	void on_vblank();
+
+	/// @brief Applies pending object changes to the cached components, and rebuilds the masks if they need it.
+	/// @details Working sets that were updated too recently for their refresh rate limit keep their changes until a later frame.
+	void update_frame();
+
+	/// @brief Returns how long the housekeeping timer can sleep before it's needed again
+	/// @returns The timer interval in milliseconds
+	int get_housekeeping_interval_ms() const;
+
+	/// @brief Applies the object changes recorded for a working set to its cached components.
+	/// Components that can be updated in place are repainted individually. The working set's update rate limit isn't
+	/// checked here, see update_frame.
+	/// @param[in] workingSet The working set to apply changes for
+	/// @returns True if the masks need to be rebuilt because a change could not be applied in place
+	bool apply_object_changes(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
 	void check_load_settings(std::shared_ptr<ValueTree> settings);
 	void remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSetToRemove);
 	void clear_iso_data();
 
 	const std::string ISO_DATA_PATH = "iso_data";
+	static constexpr int BUSY_UPDATE_INTERVAL_MS = 50; ///< How often the housekeeping timer runs while a pool is loading or a button is held
+	static constexpr int STATUS_MESSAGE_INTERVAL_MS = 1000; ///< How often the VT status message is sent
 
 	juce::ApplicationCommandManager mCommandManager;
 	WorkingSetSelectorComponent workingSetSelector;
@@ -190,12 +236,19 @@ private:
 	LoggerComponent logger;
 	Viewport loggerViewport;
 	VT_NumberComponent vtNumberComponent;
+#ifdef AGISOVT_PAINT_PROFILING
+	PaintProfilerOverlayComponent paintProfilerOverlay;
+#endif
+	ObjectChangeTracker objectChangeTracker;
+	UpdateRateGovernor updateRateGovernor;
+	StoredVersionCatalog storedVersionCatalog; ///< The object pool versions stored for each client
 	SoundPlayer mSoundPlayer;
 	AudioDeviceManager mAudioDeviceManager;
 	std::unique_ptr<isobus::TimeDateInterface> timeServingInterface;
 	std::unique_ptr<isobus::DiagnosticProtocol> diagnosticProtocol;
 	std::unique_ptr<AlertWindow> popupMenu;
 	std::unique_ptr<ConfigureHardwareWindow> configureHardwareWindow;
+	std::unique_ptr<VBlankAttachment> frameAttachment; ///< Paces mask updates to the display, only attached while updates are pending
 	std::shared_ptr<isobus::ControlFunction> alarmAckKeyWs;
 	std::vector<std::shared_ptr<isobus::CANHardwarePlugin>> &parentCANDrivers;
 	std::vector<HeldButtonData> heldButtons;
@@ -204,6 +257,8 @@ private:
 	std::uint8_t vtNumber = 1; // VT number in the range of 1-32
 	std::uint8_t numberOfPoolsToRender = 0;
 	VTVersion versionToReport = VTVersion::Version5;
+	std::atomic<bool> framePending{ false }; ///< Set from any thread when there are object changes to apply
+	std::atomic<bool> housekeepingWakePending{ false }; ///< Set from the CAN thread when a client starts pool work that the housekeeping timer needs to watch
 	bool needToRepaint = false;
 	bool autostart = false;
 	bool hasStartBeenCalled = false;
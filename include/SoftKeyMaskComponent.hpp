@@ -45,6 +45,77 @@ public:
 	static constexpr std::uint8_t PADDING = 10;
 };
 
+/// @brief Where each key of a soft key mask goes, computed once for a mask and a set of dimensions.
+/// @details Keys fill the right most column from top to bottom, then the next column to the left.
+/// When a mask has more keys than there are physical key positions, the extra keys go on further pages,
+/// and the last positions of every page are taken by the navigation keys that flip between pages.
+class SoftKeyLayout
+{
+public:
+	/// @brief The navigation keys, in the order they take up the last positions of a page
+	enum class NavigationKey : std::uint8_t
+	{
+		PreviousPage = 0,
+		NextPage = 1
+	};
+
+	/// @brief How many physical key positions are used for navigation when a mask needs more than one page
+	static constexpr std::uint8_t NUMBER_OF_NAVIGATION_KEYS = 2;
+
+	/// @brief The position of one key
+	struct KeySlot
+	{
+		std::uint16_t objectID; ///< The key or object pointer that occupies the slot
+		std::size_t page; ///< The page the slot is on
+		int x; ///< The x position of the slot within the mask
+		int y; ///< The y position of the slot within the mask
+	};
+
+	SoftKeyLayout() = default;
+
+	/// @brief Lays out the children of a soft key mask
+	/// @param[in] workingSet The working set that owns the mask
+	/// @param[in] softKeyMask The mask to lay out
+	/// @param[in] dimensions The physical soft key dimensions
+	SoftKeyLayout(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const isobus::SoftKeyMask &softKeyMask, const SoftKeyMaskDimensions &dimensions);
+
+	/// @brief Returns every key slot, in the mask's child order
+	/// @returns The key slots
+	const std::vector<KeySlot> &get_slots() const;
+
+	/// @brief Returns how many pages are needed to show every key
+	/// @returns The number of pages, which is at least one
+	std::size_t get_number_of_pages() const;
+
+	/// @brief Returns the slot at a position on a page
+	/// @param[in] x The x position within the mask
+	/// @param[in] y The y position within the mask
+	/// @param[in] page The page being shown
+	/// @returns The slot at the position, or nullptr if there is none
+	const KeySlot *find_slot(int x, int y, std::size_t page) const;
+
+	/// @brief Returns if the layout has more than one page, and so shows navigation keys
+	/// @returns true if the last positions of each page hold navigation keys, otherwise false
+	bool has_navigation_keys() const;
+
+	/// @brief Returns where a navigation key is drawn
+	/// @param[in] key The navigation key to get the position of
+	/// @returns The bounds of the navigation key within the mask, which is empty if the layout has no navigation keys
+	Rectangle<int> get_navigation_key_bounds(NavigationKey key) const;
+
+private:
+	/// @brief Returns the position of a key within the mask from its position on a page
+	/// @param[in] positionOnPage The zero based position on the page, in the order keys are filled in
+	/// @returns The top left corner of the key
+	Point<int> get_position(int positionOnPage) const;
+
+	std::vector<KeySlot> slots; ///< The key slots in child order
+	SoftKeyMaskDimensions dimensionInfo; ///< The dimensions the layout was made for
+	std::size_t numberOfPages = 1; ///< How many pages the keys span
+	std::size_t keysPerPage = 1; ///< How many of the mask's keys fit on each page, not counting navigation keys
+	bool navigationKeys = false; ///< Whether the last positions of each page are navigation keys
+};
+
 class SoftKeyMaskComponent : public isobus::SoftKeyMask
   , public Component
 {
@@ -55,10 +126,24 @@ public:
 
 	void paint(Graphics &g) override;
 
+	/// @brief Returns where each key of the mask is drawn
+	/// @returns The mask's key layout
+	const SoftKeyLayout &get_layout() const;
+
+	/// @brief Returns the page of keys currently shown
+	/// @returns The zero based page index
+	std::size_t get_page() const;
+
+	/// @brief Shows a different page of keys, for masks that have more keys than physical key positions
+	/// @param[in] page The page to show, which wraps around past the last page
+	void set_page(std::size_t page);
+
 private:
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
-	std::vector<std::shared_ptr<Component>> childComponents;
+	std::vector<std::shared_ptr<Component>> childComponents; ///< The key components, in the same order as the layout's slots
 	SoftKeyMaskDimensions dimensionInfo;
+	SoftKeyLayout layout;
+	std::size_t currentPage = 0;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoftKeyMaskComponent)
 };
@@ -13,6 +13,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "SoftKeyMaskComponent.hpp"
 
 class ServerMainComponent;
 
@@ -33,13 +34,26 @@ public:
 	// Used to calculate button release events
 	void mouseUp(const MouseEvent &event) override;
 
+	// Used to flip between pages of soft keys when a mask has more keys than fit
+	void mouseWheelMove(const MouseEvent &event, const MouseWheelDetails &wheel) override;
+
 private:
-	std::shared_ptr<isobus::VTObject> getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y);
-	static bool objectCanBeClicked(std::shared_ptr<isobus::VTObject> object);
-	static bool isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight);
+	std::shared_ptr<SoftKeyMaskComponent> getSoftKeyMaskComponent() const;
+	std::shared_ptr<isobus::VTObject> getClickedKey(int x, int y);
+
+	/// @brief Shows a page of the current soft key mask and updates the navigation keys to match
+	/// @param[in] page The page to show, which wraps around past the last page
+	void showPage(std::size_t page);
+
+	/// @brief Places and labels the navigation keys, or hides them if the current mask fits on one page
+	void updateNavigationKeys();
+
+	static constexpr std::uint8_t MAX_POINTER_DEPTH = 8; ///< How many object pointers in a row will be followed to find a key
 
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
 	std::vector<std::shared_ptr<Component>> childComponents;
+	TextButton previousPageButton; ///< Navigation key that shows the previous page of soft keys
+	TextButton nextPageButton; ///< Navigation key that shows the next page of soft keys, and which page is shown
 	ServerMainComponent &ownerServer;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoftKeyMaskRenderAreaComponent)
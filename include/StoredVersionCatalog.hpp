@@ -0,0 +1,104 @@
+//================================================================================================
+/// @file StoredVersionCatalog.hpp
+///
+/// @brief Keeps track of the object pool versions stored for each client, so version requests
+/// don't have to open every stored file to find their labels.
+/// @details The catalog is saved next to the stored pools as a small index file. When it's built,
+/// files whose size and modification time match the index aren't opened again.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef STORED_VERSION_CATALOG_HPP
+#define STORED_VERSION_CATALOG_HPP
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class StoredVersionCatalog
+{
+public:
+	/// @brief The 7 byte label a client gives each stored version of its object pool
+	using VersionLabel = std::array<std::uint8_t, 7>;
+
+	/// @brief One stored version of a client's object pool
+	struct StoredVersion
+	{
+		VersionLabel label = {}; ///< The version label the pool was stored with
+		std::filesystem::path path; ///< The .iopx file, which holds the label followed by the pool
+		std::uintmax_t size = 0; ///< The size of the file in bytes, including the label
+		std::int64_t lastModified = 0; ///< The file's modification time when it was catalogued, in file clock ticks
+		std::uint32_t checksum = 0; ///< The checksum of the object pool, not including the label
+	};
+
+	StoredVersionCatalog() = default;
+
+	/// @brief Catalogs every stored version in a directory and saves the index file.
+	/// Files that are unchanged since the index was last saved are taken from the index without being opened.
+	/// @param[in] isoDataDirectory The directory that holds one subdirectory of stored pools per client NAME
+	void build(const std::filesystem::path &isoDataDirectory);
+
+	/// @brief Returns the distinct version labels stored for a client
+	/// @param[in] clientNAME The full NAME of the client
+	/// @returns The version labels, without duplicates
+	std::vector<VersionLabel> get_version_labels(std::uint64_t clientNAME) const;
+
+	/// @brief Returns the stored files that have a particular version label
+	/// @param[in] clientNAME The full NAME of the client
+	/// @param[in] label The version label to look for
+	/// @returns The matching stored versions, which is empty if there are none
+	std::vector<StoredVersion> get_versions(std::uint64_t clientNAME, const VersionLabel &label) const;
+
+	/// @brief Adds a version that was just written to disk, and saves the index file
+	/// @param[in] clientNAME The full NAME of the client
+	/// @param[in] label The version label the pool was stored with
+	/// @param[in] path The .iopx file that was written
+	/// @param[in] objectPool The object pool that was written after the label
+	void add_version(std::uint64_t clientNAME, const VersionLabel &label, const std::filesystem::path &path, const std::vector<std::uint8_t> &objectPool);
+
+	/// @brief Removes all of a client's versions with a particular label, and saves the index file
+	/// @param[in] clientNAME The full NAME of the client
+	/// @param[in] label The version label to remove
+	void remove_version(std::uint64_t clientNAME, const VersionLabel &label);
+
+	/// @brief Removes all of a client's versions, and saves the index file
+	/// @param[in] clientNAME The full NAME of the client
+	void remove_client(std::uint64_t clientNAME);
+
+	/// @brief Removes every version of every client, and saves the index file if its directory still exists
+	void clear();
+
+	/// @brief Calculates the checksum that is stored for each object pool (32 bit FNV-1a)
+	/// @param[in] data The object pool
+	/// @param[in] size The number of bytes in the object pool
+	/// @returns The checksum
+	static std::uint32_t calculate_checksum(const std::uint8_t *data, std::size_t size);
+
+	/// @brief The name of the index file, which is saved in the directory passed to build
+	static constexpr const char *INDEX_FILE_NAME = "version_index.xml";
+
+private:
+	/// @brief Reads a stored version's label and checksum from its file
+	/// @param[in] path The .iopx file to read
+	/// @param[out] version The stored version to fill in
+	/// @returns true if the file could be read and holds a label, otherwise false
+	static bool read_version_file(const std::filesystem::path &path, StoredVersion &version);
+
+	/// @brief Returns the modification time of a file as a plain number that can be saved in the index
+	/// @param[in] path The file to check
+	/// @returns The modification time in file clock ticks, or 0 if it couldn't be read
+	static std::int64_t get_last_modified(const std::filesystem::path &path);
+
+	/// @brief Writes the catalog to the index file. The mutex must be held by the caller.
+	void save_index() const;
+
+	std::map<std::uint64_t, std::vector<StoredVersion>> versions; ///< The stored versions of each client, by full NAME
+	std::filesystem::path directory; ///< The directory the catalog was built from
+	mutable std::mutex catalogMutex; ///< Protects the catalog, since the VT server callbacks may run on the CAN thread
+};
+
+#endif // STORED_VERSION_CATALOG_HPP
@@ -21,6 +21,12 @@ enum class SourceEncoding
 	ISO8859_15
 };
 
+/// @brief Converts a string to UTF-8, appending it to the output
+/// @details Runs of printable ASCII are copied straight through, and only other bytes go through the encoding's table.
+/// @param[in] encoding The encoding of the input string
+/// @param[in] input The string to convert
+/// @param[in,out] output The string to append the converted text to
+/// @param[in] autoWrappingEnabled Whether soft hyphens should wrap
 void convert_string_to_utf_8(SourceEncoding encoding, const std::string &input, std::string &output, bool autoWrappingEnabled);
 
 #endif // STRING_ENCODING_CONVERSIONS_HPP
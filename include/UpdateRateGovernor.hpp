@@ -0,0 +1,85 @@
+//================================================================================================
+/// @file UpdateRateGovernor.hpp
+///
+/// @brief Limits how often each working set's changes are applied to the screen, so one client
+/// that sends changes very quickly can't use up all of the GUI's time.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#ifndef UPDATE_RATE_GOVERNOR_HPP
+#define UPDATE_RATE_GOVERNOR_HPP
+
+#include "isobus/isobus/can_control_function.hpp"
+
+#include <map>
+#include <memory>
+
+class UpdateRateGovernor
+{
+public:
+	/// @brief The refresh rate limit used for clients that don't have one of their own
+	static constexpr std::uint32_t DEFAULT_MAX_REFRESH_RATE_HZ = 25;
+
+	UpdateRateGovernor() = default;
+
+	/// @brief Sets the refresh rate limit for clients that don't have one of their own
+	/// @param[in] maxRefreshRate_Hz The most visual updates per second, or 0 for no limit
+	void set_default_max_refresh_rate(std::uint32_t maxRefreshRate_Hz);
+
+	/// @brief Returns the refresh rate limit for clients that don't have one of their own
+	/// @returns The most visual updates per second, or 0 if there is no limit
+	std::uint32_t get_default_max_refresh_rate() const;
+
+	/// @brief Sets the refresh rate limit for one client, identified by its NAME
+	/// @param[in] clientNAME The full NAME of the client
+	/// @param[in] maxRefreshRate_Hz The most visual updates per second, or 0 for no limit
+	void set_max_refresh_rate(std::uint64_t clientNAME, std::uint32_t maxRefreshRate_Hz);
+
+	/// @brief Removes a client's own refresh rate limit, so it uses the default again
+	/// @param[in] clientNAME The full NAME of the client
+	void clear_max_refresh_rate(std::uint64_t clientNAME);
+
+	/// @brief Returns the refresh rate limit that applies to a client
+	/// @param[in] clientNAME The full NAME of the client
+	/// @returns The most visual updates per second, or 0 if there is no limit
+	std::uint32_t get_max_refresh_rate(std::uint64_t clientNAME) const;
+
+	/// @brief Returns the clients that have their own refresh rate limit
+	/// @returns The limits in updates per second, by full client NAME
+	const std::map<std::uint64_t, std::uint32_t> &get_max_refresh_rate_overrides() const;
+
+	/// @brief Checks if a client's changes can be applied to the screen now, and if so, starts a new update period for it
+	/// @param[in] client The client with changes waiting
+	/// @returns true if the changes should be applied now, false if they should wait for a later frame
+	bool try_begin_update(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief Records how many repaint requests were combined into one visual update
+	/// @param[in] client The client that was updated
+	/// @param[in] repaintRequests The number of repaint requests the applied changes were gathered from
+	void on_update_applied(std::shared_ptr<isobus::ControlFunction> client, std::uint32_t repaintRequests);
+
+	/// @brief Returns how many intermediate frames of a client were never shown, because later changes replaced them first
+	/// @param[in] client The client to check
+	/// @returns The number of dropped frames since the client connected
+	std::uint32_t get_dropped_frames(std::shared_ptr<isobus::ControlFunction> client) const;
+
+	/// @brief Forgets a client's update timing and statistics, such as when it disconnects
+	/// @param[in] client The client to forget
+	void remove_client(std::shared_ptr<isobus::ControlFunction> client);
+
+private:
+	/// @brief The update timing and statistics of one client
+	struct ClientState
+	{
+		std::uint32_t lastUpdateTimestamp_ms = 0; ///< When the client's changes were last applied
+		std::uint32_t droppedFrames = 0; ///< Repaint requests that were combined into a later update
+		bool hasUpdated = false; ///< If the client's changes have been applied at least once
+	};
+
+	std::map<std::shared_ptr<isobus::ControlFunction>, ClientState> clientStates; ///< Timing and statistics for each client
+	std::map<std::uint64_t, std::uint32_t> maxRefreshRateOverrides; ///< Refresh rate limits by full client NAME
+	std::uint32_t defaultMaxRefreshRate_Hz = DEFAULT_MAX_REFRESH_RATE_HZ; ///< The limit for clients without their own
+};
+
+#endif // UPDATE_RATE_GOVERNOR_HPP
@@ -5,13 +5,14 @@
 *******************************************************************************/
 #include "ButtonComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 ButtonComponent::ButtonComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::Button sourceObject) :
   isobus::Button(sourceObject),
   juce::Button(""),
   parentWorkingSet(workingSet)
 {
-	setOpaque(false);
+	setOpaque(!get_option(Options::TransparentBackground));
 	setSize(get_width(), get_height());
 
 	auto borderOffset = get_option(Options::NoBorder) ? 0 : 4;
@@ -35,21 +36,23 @@ ButtonComponent::ButtonComponent(std::shared_ptr<isobus::VirtualTerminalServerMa
 
 void ButtonComponent::paint(Graphics &g)
 {
-	auto vtColour = parentWorkingSet->get_colour(backgroundColor);
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
+	auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, backgroundColor);
 
 	if (true == get_option(Options::TransparentBackground))
 	{
-		g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 0.0f));
+		g.fillAll(vtColour.withAlpha(0.0f));
 	}
 	else
 	{
-		g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+		g.fillAll(vtColour);
 	}
 
 	if (false == get_option(Options::NoBorder) && false == get_option(Options::SuppressBorder))
 	{
-		vtColour = parentWorkingSet->get_colour(get_border_colour());
-		g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+		vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_border_colour());
+		g.setColour(vtColour);
 		g.drawRect(0, 0, get_width(), get_height(), 4);
 	}
 }
@@ -5,6 +5,7 @@
 *******************************************************************************/
 #include "ContainerComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 ContainerComponent::ContainerComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::Container sourceObject) :
   isobus::Container(sourceObject),
@@ -39,6 +40,8 @@ ContainerComponent::ContainerComponent(std::shared_ptr<isobus::VirtualTerminalSe
 
 void ContainerComponent::paint(Graphics &)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	// g.fillAll(Colour::fromFloatRGBA(0.0, 0.0, 0.0, 0.0));
 	if (get_hidden())
 	{
@@ -5,6 +5,7 @@
 *******************************************************************************/
 #include "DataMaskComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 DataMaskComponent::DataMaskComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::DataMask sourceObject, int dataMaskSize) :
   isobus::DataMask(sourceObject),
@@ -41,7 +42,9 @@ void DataMaskComponent::on_content_changed(bool initial)
 
 void DataMaskComponent::paint(Graphics &g)
 {
-	auto vtColour = parentWorkingSet->get_colour(backgroundColor);
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
 
-	g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+	auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, backgroundColor);
+
+	g.fillAll(vtColour);
 }
@@ -15,8 +15,9 @@ DataMaskRenderAreaComponent::DataMaskRenderAreaComponent(ServerMainComponent &pa
 
 void DataMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
 {
-	needToRepaintActiveArea = false;
+	removeAllChildren(); // Components are cached, so they won't remove themselves when we release them
 	childComponents.clear();
+	hitTestIndex.clear();
 	parentWorkingSet = workingSet;
 
 	if (parentWorkingSet)
@@ -28,6 +29,8 @@ void DataMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobus::
 			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
 			childComponents.emplace_back(JuceManagedWorkingSetCache::create_component(parentWorkingSet, activeMask));
 			addAndMakeVisible(*childComponents.back());
+			update_occlusion(*childComponents.back());
+			JuceManagedWorkingSetCache::update_static_layers(parentWorkingSet, *childComponents.back());
 		}
 	}
 	repaint();
@@ -37,12 +40,69 @@ void DataMaskRenderAreaComponent::on_working_set_disconnect(std::shared_ptr<isob
 {
 	if ((nullptr != workingSet) && (parentWorkingSet == workingSet))
 	{
+		removeAllChildren();
 		childComponents.clear();
+		hitTestIndex.clear();
 		parentWorkingSet.reset();
 		repaint();
 	}
 }
 
+void DataMaskRenderAreaComponent::on_objects_changed(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const ObjectChangeTracker::ChangeSet &changes)
+{
+	if ((nullptr != workingSet) && (parentWorkingSet == workingSet))
+	{
+		bool indexOutdated = changes.fullRefreshNeeded;
+
+		for (auto changedObject = changes.changedObjects.begin(); (!indexOutdated) && (changes.changedObjects.end() != changedObject); changedObject++)
+		{
+			indexOutdated = hitTestIndex.depends_on(*changedObject);
+		}
+
+		if (indexOutdated)
+		{
+			hitTestIndex.clear();
+		}
+
+		for (auto &child : childComponents)
+		{
+			if (nullptr != child)
+			{
+				update_occlusion(*child);
+			}
+		}
+	}
+}
+
+bool DataMaskRenderAreaComponent::update_occlusion(Component &component)
+{
+	bool coveredByChild = false;
+
+	for (auto child : component.getChildren())
+	{
+		// Children above this one in z-order are later in the list, and any of them can cover the whole component
+		if (update_occlusion(*child) &&
+		    child->isVisible() &&
+		    child->getTransform().isIdentity() &&
+		    child->getBounds().contains(component.getLocalBounds()))
+		{
+			coveredByChild = true;
+		}
+	}
+
+	auto vtObject = dynamic_cast<const isobus::VTObject *>(&component);
+
+	if ((nullptr != vtObject) &&
+	    ((isobus::VirtualTerminalObjectType::Container == vtObject->get_object_type()) ||
+	     (isobus::VirtualTerminalObjectType::ObjectPointer == vtObject->get_object_type())) &&
+	    (coveredByChild != component.isOpaque()))
+	{
+		// These don't draw anything themselves, so they're exactly as opaque as what covers them
+		component.setOpaque(coveredByChild);
+	}
+	return component.isOpaque();
+}
+
 void DataMaskRenderAreaComponent::paint(Graphics &g)
 {
 	g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
@@ -77,7 +137,7 @@ void DataMaskRenderAreaComponent::mouseDown(const MouseEvent &event)
 			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
 
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
+			auto clickedObject = getClickedObject(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
 
 			std::uint8_t keyCode = 1;
 
@@ -126,7 +186,7 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
 
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
+			auto clickedObject = getClickedObject(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
 
 			std::uint8_t keyCode = 1;
 
@@ -262,6 +322,7 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 											if (std::static_pointer_cast<isobus::NumberVariable>(child)->get_value() != static_cast<std::uint32_t>(result))
 											{
 												std::static_pointer_cast<isobus::NumberVariable>(child)->set_value(result);
+												JuceManagedWorkingSetCache::invalidate_object(parentWorkingSet, child->get_id());
 												ownerServer.send_change_numeric_value_message(child->get_id(), result, ownerServer.get_client_control_function_for_working_set(parentWorkingSet));
 												ownerServer.process_macro(child, isobus::EventID::OnChangeValue, isobus::VirtualTerminalObjectType::NumberVariable, parentWorkingSet);
 											}
@@ -275,6 +336,7 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 									{
 										ownerServer.process_macro(clickedList, isobus::EventID::OnEntryOfANewValue, isobus::VirtualTerminalObjectType::InputList, parentWorkingSet);
 										clickedList->set_value(static_cast<std::uint8_t>(result));
+										JuceManagedWorkingSetCache::invalidate_object(parentWorkingSet, clickedList->get_id());
 										ownerServer.send_change_numeric_value_message(clickedList->get_id(), result, ownerServer.get_client_control_function_for_working_set(parentWorkingSet));
 										ownerServer.process_macro(clickedList, isobus::EventID::OnChangeValue, isobus::VirtualTerminalObjectType::InputList, parentWorkingSet);
 									}
@@ -368,11 +430,12 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 										{
 											ownerServer.process_macro(clickedNumber, isobus::EventID::OnEntryOfANewValue, isobus::VirtualTerminalObjectType::InputNumber, parentWorkingSet);
 											clickedNumber->set_value(inputNumberListener.get_last_value());
+											JuceManagedWorkingSetCache::invalidate_object(parentWorkingSet, clickedNumber->get_id());
 											ownerServer.process_macro(clickedNumber, isobus::EventID::OnChangeValue, isobus::VirtualTerminalObjectType::InputNumber, parentWorkingSet);
 										}
 									}
 
-									this->needToRepaintActiveArea = true;
+									ownerServer.repaint_on_next_update();
 								}
 								inputNumberListener.set_target(nullptr);
 								inputNumberModal.reset();
@@ -444,6 +507,10 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 							if (!hasNumberVariable)
 							{
 								clickedBool->set_value(clickedBool->get_value() != 0 ? 0 : 1);
+								if (!JuceManagedWorkingSetCache::update_object(parentWorkingSet, clickedBool->get_id()))
+								{
+									ownerServer.repaint_on_next_update();
+								}
 								ownerServer.send_change_numeric_value_message(clickedBool->get_id(), clickedBool->get_value(), ownerServer.get_client_control_function_for_working_set(parentWorkingSet));
 								ownerServer.process_macro(clickedBool, isobus::EventID::OnChangeValue, isobus::VirtualTerminalObjectType::InputBoolean, parentWorkingSet);
 							}
@@ -511,10 +578,11 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 											ownerServer.process_macro(clickedString, isobus::EventID::OnEntryOfANewValue, isobus::VirtualTerminalObjectType::InputString, parentWorkingSet);
 										}
 										clickedString->set_value(newContent.toStdString());
+										JuceManagedWorkingSetCache::invalidate_object(parentWorkingSet, clickedString->get_id());
 										ownerServer.send_change_string_value_message(clickedString->get_id(), newContent.toStdString(), ownerServer.get_client_control_function_for_working_set(parentWorkingSet));
 										ownerServer.process_macro(clickedString, isobus::EventID::OnChangeValue, isobus::VirtualTerminalObjectType::InputString, parentWorkingSet);
 									}
-									needToRepaintActiveArea = true;
+									ownerServer.repaint_on_next_update();
 								}
 								inputStringModal->exitModalState();
 								inputStringModal.reset();
@@ -543,11 +611,6 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 	}
 }
 
-bool DataMaskRenderAreaComponent::needsRepaint() const
-{
-	return needToRepaintActiveArea;
-}
-
 void DataMaskRenderAreaComponent::set_has_started(bool started)
 {
 	hasStarted = started;
@@ -583,90 +646,23 @@ void DataMaskRenderAreaComponent::InputNumberListener::set_target(std::shared_pt
 	targetObject = objectBeingModified;
 }
 
-std::shared_ptr<isobus::VTObject> DataMaskRenderAreaComponent::getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y)
+std::shared_ptr<isobus::VTObject> DataMaskRenderAreaComponent::getClickedObject(std::shared_ptr<isobus::VTObject> activeMask, int x, int y)
 {
 	std::shared_ptr<isobus::VTObject> retVal;
 
-	if ((nullptr == object) ||
-	    (nullptr == parentWorkingSet) ||
-	    ((isobus::VirtualTerminalObjectType::ObjectPointer != object->get_object_type()) &&
-	     (0 == object->get_number_children())))
+	if ((nullptr != activeMask) && (nullptr != parentWorkingSet))
 	{
-		return nullptr;
-	}
-
-	if (isobus::VirtualTerminalObjectType::ObjectPointer == object->get_object_type())
-	{
-		auto child = object->get_object_by_id(std::static_pointer_cast<isobus::ObjectPointer>(object)->get_value(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) &&
-		    (objectCanBeClicked(child)) &&
-		    (isClickWithinBounds(x, y, 0, 0, child->get_width(), child->get_height())))
+		if (!hitTestIndex.is_built_for(activeMask->get_id()))
 		{
-			return child;
+			hitTestIndex.build(parentWorkingSet, activeMask);
 		}
-		else if (!objectCanBeClicked(child))
-		{
-			retVal = getClickedChildRecursive(child, x, y);
-		}
-	}
-	else
-	{
-		for (std::uint16_t i = 0; i < object->get_number_children(); i++)
-		{
-			auto child = object->get_object_by_id(object->get_child_id(i), parentWorkingSet->get_object_tree());
 
-			if ((nullptr != child) &&
-			    (objectCanBeClicked(child)) &&
-			    (isClickWithinBounds(x, y, object->get_child_x(i), object->get_child_y(i), child->get_width(), child->get_height())))
-			{
-				return child;
-			}
-			else if (!objectCanBeClicked(child))
-			{
-				retVal = getClickedChildRecursive(child, x - object->get_child_x(i), y - object->get_child_y(i));
+		auto clickedObjectID = hitTestIndex.find_object(x, y);
 
-				if (nullptr != retVal)
-				{
-					break;
-				}
-			}
-		}
-	}
-	return retVal;
-}
-
-bool DataMaskRenderAreaComponent::objectCanBeClicked(std::shared_ptr<isobus::VTObject> object)
-{
-	bool retVal = false;
-
-	if (nullptr != object)
-	{
-		switch (object->get_object_type())
+		if (isobus::NULL_OBJECT_ID != clickedObjectID)
 		{
-			case isobus::VirtualTerminalObjectType::Button:
-			case isobus::VirtualTerminalObjectType::InputList:
-			case isobus::VirtualTerminalObjectType::Key:
-			case isobus::VirtualTerminalObjectType::InputNumber:
-			case isobus::VirtualTerminalObjectType::InputBoolean:
-			case isobus::VirtualTerminalObjectType::InputString:
-			{
-				retVal = true;
-			}
-			break;
-
-			default:
-			{
-				retVal = false;
-			}
-			break;
+			retVal = parentWorkingSet->get_object_by_id(clickedObjectID);
 		}
 	}
 	return retVal;
 }
-
-bool DataMaskRenderAreaComponent::isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight)
-{
-	return ((clickXRelative >= objectX) && (clickXRelative <= (objectX + objectWidth))) &&
-	  ((clickYRelative >= objectY) && (clickYRelative <= (objectY + objectHeight)));
-}
@@ -0,0 +1,80 @@
+/*******************************************************************************
+** @file       FlashScheduler.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "FlashScheduler.hpp"
+
+#include <map>
+
+JUCE_IMPLEMENT_SINGLETON(FlashScheduler)
+
+FlashScheduler::~FlashScheduler()
+{
+	clearSingletonInstance();
+}
+
+void FlashScheduler::subscribe(Component *component)
+{
+	auto instance = getInstance();
+
+	if ((nullptr != instance) && (nullptr != component) && instance->subscribers.insert(component).second && !instance->isTimerRunning())
+	{
+		instance->shown = true;
+		instance->startTimer(FLASH_PHASE_MS);
+	}
+}
+
+void FlashScheduler::unsubscribe(Component *component)
+{
+	auto instance = getInstanceWithoutCreating();
+
+	if ((nullptr != instance) && (0 != instance->subscribers.erase(component)) && instance->subscribers.empty())
+	{
+		instance->stopTimer();
+		instance->shown = true;
+	}
+}
+
+bool FlashScheduler::is_subscribed(const Component *component)
+{
+	auto instance = getInstanceWithoutCreating();
+	return (nullptr != instance) && (instance->subscribers.end() != instance->subscribers.find(const_cast<Component *>(component)));
+}
+
+bool FlashScheduler::is_shown()
+{
+	auto instance = getInstanceWithoutCreating();
+	return (nullptr == instance) || instance->shown;
+}
+
+void FlashScheduler::timerCallback()
+{
+	std::map<Component *, Rectangle<int>> dirtyAreas;
+
+	shown = !shown;
+
+	for (auto subscriber : subscribers)
+	{
+		if (subscriber->isShowing())
+		{
+			auto topLevelComponent = subscriber->getTopLevelComponent();
+			auto area = topLevelComponent->getLocalArea(subscriber, subscriber->getLocalBounds());
+			auto dirtyArea = dirtyAreas.find(topLevelComponent);
+
+			if (dirtyAreas.end() != dirtyArea)
+			{
+				dirtyArea->second = dirtyArea->second.getUnion(area);
+			}
+			else
+			{
+				dirtyAreas[topLevelComponent] = area;
+			}
+		}
+	}
+
+	for (auto &dirtyArea : dirtyAreas)
+	{
+		dirtyArea.first->repaint(dirtyArea.second);
+	}
+}
@@ -0,0 +1,190 @@
+/*******************************************************************************
+** @file       HitTestIndex.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "HitTestIndex.hpp"
+
+#include <algorithm>
+
+void HitTestIndex::build(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> rootObject)
+{
+	clear();
+
+	if ((nullptr != workingSet) && (nullptr != rootObject))
+	{
+		rootObjectID = rootObject->get_id();
+		add_children(workingSet, rootObject, 0, 0);
+
+		if (!entries.empty())
+		{
+			int gridRight = entries.front().right;
+			int gridBottom = entries.front().bottom;
+			gridLeft = entries.front().left;
+			gridTop = entries.front().top;
+
+			for (const auto &entry : entries)
+			{
+				gridLeft = std::min(gridLeft, entry.left);
+				gridTop = std::min(gridTop, entry.top);
+				gridRight = std::max(gridRight, entry.right);
+				gridBottom = std::max(gridBottom, entry.bottom);
+			}
+			// Objects can be placed far outside the mask, so grow the cells rather than let the grid get huge
+			cellSize = std::max({ MIN_CELL_SIZE, ((gridRight - gridLeft) / MAX_GRID_DIMENSION) + 1, ((gridBottom - gridTop) / MAX_GRID_DIMENSION) + 1 });
+			gridColumns = ((gridRight - gridLeft) / cellSize) + 1;
+			gridRows = ((gridBottom - gridTop) / cellSize) + 1;
+			cells.resize(static_cast<std::size_t>(gridColumns) * static_cast<std::size_t>(gridRows));
+
+			for (std::uint32_t i = 0; i < entries.size(); i++)
+			{
+				const int firstColumn = (entries[i].left - gridLeft) / cellSize;
+				const int lastColumn = (entries[i].right - gridLeft) / cellSize;
+				const int firstRow = (entries[i].top - gridTop) / cellSize;
+				const int lastRow = (entries[i].bottom - gridTop) / cellSize;
+
+				for (int row = firstRow; row <= lastRow; row++)
+				{
+					for (int column = firstColumn; column <= lastColumn; column++)
+					{
+						cells[static_cast<std::size_t>(row) * static_cast<std::size_t>(gridColumns) + static_cast<std::size_t>(column)].push_back(i);
+					}
+				}
+			}
+		}
+	}
+	built = true;
+}
+
+void HitTestIndex::clear()
+{
+	entries.clear();
+	cells.clear();
+	dependencies.clear();
+	gridLeft = 0;
+	gridTop = 0;
+	gridColumns = 0;
+	gridRows = 0;
+	cellSize = MIN_CELL_SIZE;
+	rootObjectID = isobus::NULL_OBJECT_ID;
+	built = false;
+}
+
+bool HitTestIndex::is_built_for(std::uint16_t objectID) const
+{
+	return built && (rootObjectID == objectID);
+}
+
+bool HitTestIndex::depends_on(std::uint16_t objectID) const
+{
+	return (dependencies.end() != dependencies.find(objectID));
+}
+
+std::uint16_t HitTestIndex::find_object(int x, int y) const
+{
+	std::uint16_t retVal = isobus::NULL_OBJECT_ID;
+
+	if ((x >= gridLeft) && (y >= gridTop))
+	{
+		const int column = (x - gridLeft) / cellSize;
+		const int row = (y - gridTop) / cellSize;
+
+		if ((column < gridColumns) && (row < gridRows))
+		{
+			for (auto entryIndex : cells[static_cast<std::size_t>(row) * static_cast<std::size_t>(gridColumns) + static_cast<std::size_t>(column)])
+			{
+				const auto &entry = entries[entryIndex];
+
+				if ((x >= entry.left) && (x <= entry.right) && (y >= entry.top) && (y <= entry.bottom))
+				{
+					retVal = entry.objectID;
+					break;
+				}
+			}
+		}
+	}
+	return retVal;
+}
+
+bool HitTestIndex::can_be_clicked(std::shared_ptr<isobus::VTObject> object)
+{
+	bool retVal = false;
+
+	if (nullptr != object)
+	{
+		switch (object->get_object_type())
+		{
+			case isobus::VirtualTerminalObjectType::Button:
+			case isobus::VirtualTerminalObjectType::InputList:
+			case isobus::VirtualTerminalObjectType::Key:
+			case isobus::VirtualTerminalObjectType::InputNumber:
+			case isobus::VirtualTerminalObjectType::InputBoolean:
+			case isobus::VirtualTerminalObjectType::InputString:
+			{
+				retVal = true;
+			}
+			break;
+
+			default:
+			{
+				retVal = false;
+			}
+			break;
+		}
+	}
+	return retVal;
+}
+
+void HitTestIndex::add_children(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> object, int x, int y)
+{
+	if ((nullptr == object) ||
+	    ((isobus::VirtualTerminalObjectType::ObjectPointer != object->get_object_type()) &&
+	     (0 == object->get_number_children())))
+	{
+		return;
+	}
+
+	dependencies.insert(object->get_id());
+
+	if (isobus::VirtualTerminalObjectType::ObjectPointer == object->get_object_type())
+	{
+		auto child = object->get_object_by_id(std::static_pointer_cast<isobus::ObjectPointer>(object)->get_value(), workingSet->get_object_tree());
+
+		if (can_be_clicked(child))
+		{
+			add_entry(child, x, y);
+		}
+		else
+		{
+			add_children(workingSet, child, x, y);
+		}
+	}
+	else
+	{
+		for (std::uint16_t i = 0; i < object->get_number_children(); i++)
+		{
+			auto child = object->get_object_by_id(object->get_child_id(i), workingSet->get_object_tree());
+
+			if (can_be_clicked(child))
+			{
+				add_entry(child, x + object->get_child_x(i), y + object->get_child_y(i));
+			}
+			else
+			{
+				add_children(workingSet, child, x + object->get_child_x(i), y + object->get_child_y(i));
+			}
+		}
+	}
+}
+
+void HitTestIndex::add_entry(std::shared_ptr<isobus::VTObject> object, int x, int y)
+{
+	Entry entry;
+	entry.left = x;
+	entry.top = y;
+	entry.right = x + object->get_width();
+	entry.bottom = y + object->get_height();
+	entry.objectID = object->get_id();
+	entries.push_back(entry);
+	dependencies.insert(object->get_id());
+}
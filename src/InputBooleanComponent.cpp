@@ -4,6 +4,8 @@
 ** @copyright  The Open-Agriculture Developers
 *******************************************************************************/
 #include "InputBooleanComponent.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 InputBooleanComponent::InputBooleanComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::InputBoolean sourceObject) :
   isobus::InputBoolean(sourceObject),
@@ -17,9 +19,11 @@ InputBooleanComponent::InputBooleanComponent(std::shared_ptr<isobus::VirtualTerm
 
 void InputBooleanComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	// Draw background
-	auto vtColour = parentWorkingSet->get_colour(get_background_color());
-	g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+	auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_background_color());
+	g.setColour(vtColour);
 	g.fillRect(0, 0, static_cast<int>(get_width()), static_cast<int>(get_height()));
 
 	g.setColour(Colour::fromFloatRGBA(0.0f, 0.0f, 0.0f, 1.0f));
@@ -30,8 +34,8 @@ void InputBooleanComponent::paint(Graphics &g)
 
 		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::FontAttributes == child->get_object_type()))
 		{
-			vtColour = parentWorkingSet->get_colour(std::static_pointer_cast<isobus::FontAttributes>(child)->get_background_color());
-			g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+			vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, std::static_pointer_cast<isobus::FontAttributes>(child)->get_background_color());
+			g.setColour(vtColour);
 		}
 	}
 
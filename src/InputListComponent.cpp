@@ -5,6 +5,7 @@
 *******************************************************************************/
 #include "InputListComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 InputListComponent::InputListComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::InputList sourceObject) :
   isobus::InputList(sourceObject),
@@ -21,6 +22,8 @@ void InputListComponent::paint(Graphics &)
 
 void InputListComponent::paintOverChildren(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	if (!get_option(Options::Enabled))
 	{
 		g.fillAll(Colour::fromFloatRGBA(0.5f, 0.5f, 0.5f, 0.5f));
@@ -33,17 +36,10 @@ void InputListComponent::onChanged(bool initial)
 
 	std::uint32_t selectedIndex = get_value();
 
-	if (isobus::NULL_OBJECT_ID != get_variable_reference())
+	auto variable = numberVariable.get(parentWorkingSet, get_variable_reference(), isobus::VirtualTerminalObjectType::NumberVariable);
+	if (nullptr != variable)
 	{
-		auto child = get_object_by_id(get_variable_reference(), parentWorkingSet->get_object_tree());
-
-		if (nullptr != child)
-		{
-			if (isobus::VirtualTerminalObjectType::NumberVariable == child->get_object_type())
-			{
-				selectedIndex = std::static_pointer_cast<isobus::NumberVariable>(child)->get_value();
-			}
-		}
+		selectedIndex = variable->get_value();
 	}
 
 	if ((get_number_children() > 0) &&
@@ -4,7 +4,9 @@
 ** @copyright  The Open-Agriculture Developers
 *******************************************************************************/
 #include "InputStringComponent.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
 
+#include "PaintProfiler.hpp"
 #include "StringEncodingConversions.hpp"
 
 InputStringComponent::InputStringComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::InputString sourceObject) :
@@ -12,19 +14,21 @@ InputStringComponent::InputStringComponent(std::shared_ptr<isobus::VirtualTermin
   parentWorkingSet(workingSet)
 {
 	setSize(get_width(), get_height());
-	setOpaque(false);
+	setOpaque(!get_option(Options::Transparent));
 }
 
 void InputStringComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	std::string value = get_value();
 	std::uint8_t fontHeight = 0;
 	auto fontType = isobus::FontAttributes::FontType::ISO8859_1;
 
 	if (!get_option(Options::Transparent))
 	{
-		auto vtColour = parentWorkingSet->get_colour(get_background_color());
-		g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+		auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_background_color());
+		g.fillAll(vtColour);
 	}
 
 	g.setColour(getLookAndFeel().findColour(ListBox::textColourId));
@@ -41,7 +45,7 @@ void InputStringComponent::paint(Graphics &g)
 				auto font = std::static_pointer_cast<isobus::FontAttributes>(child);
 				fontType = font->get_type();
 
-				auto colour = parentWorkingSet->get_colour(font->get_colour());
+				auto colour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, font->get_colour());
 				Font juceFont;
 				int fontStyleFlags = Font::FontStyleFlags::plain;
 
@@ -65,7 +69,7 @@ void InputStringComponent::paint(Graphics &g)
 				auto fontWidth = juceFont.getStringWidthFloat("a");
 				fontHeight = font->get_font_width_pixels();
 				juceFont.setHorizontalScale(static_cast<float>(font->get_font_width_pixels()) / fontWidth);
-				g.setColour(Colour::fromFloatRGBA(colour.r, colour.g, colour.b, 1.0f));
+				g.setColour(colour);
 				g.setFont(juceFont);
 			}
 		}
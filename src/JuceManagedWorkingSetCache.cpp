@@ -12,6 +12,7 @@
 #include "DataMaskComponent.hpp"
 #include "ExtendedInputAttributesComponent.hpp"
 #include "FillAttributesComponent.hpp"
+#include "FlashScheduler.hpp"
 #include "InputBooleanComponent.hpp"
 #include "InputListComponent.hpp"
 #include "InputNumberComponent.hpp"
@@ -37,29 +38,955 @@
 #include "StringVariableComponent.hpp"
 #include "WorkingSetComponent.hpp"
 #include "WorkingSetSelectorComponent.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+template<typename ObjectType>
+static bool copy_object_state(Component &component, std::shared_ptr<isobus::VTObject> sourceObject)
+{
+	auto objectCopy = dynamic_cast<ObjectType *>(&component);
+
+	if (nullptr != objectCopy)
+	{
+		*objectCopy = *std::static_pointer_cast<ObjectType>(sourceObject);
+	}
+	return (nullptr != objectCopy);
+}
 
 std::vector<JuceManagedWorkingSetCache::ComponentCacheClass> JuceManagedWorkingSetCache::workingSetComponentCache;
+std::set<const Component *> JuceManagedWorkingSetCache::componentsHandedOutThisBuild;
+std::uint32_t JuceManagedWorkingSetCache::buildDepth = 0;
 int JuceManagedWorkingSetCache::dataAndAlarmMaskSize = 480;
 SoftKeyMaskDimensions JuceManagedWorkingSetCache::softKeyDimensionInfo = SoftKeyMaskDimensions();
 
 std::shared_ptr<Component> JuceManagedWorkingSetCache::create_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> sourceObject)
 {
 	std::shared_ptr<Component> retVal;
-	bool isWorkingSetKnown = false;
 
+	if (0 == buildDepth)
+	{
+		componentsHandedOutThisBuild.clear();
+	}
+
+	if ((nullptr != workingSet) && (nullptr != sourceObject))
+	{
+		auto &cache = get_cache(workingSet);
+		auto cachedComponents = cache.componentLookup.find(sourceObject->get_id());
+
+		if (cache.componentLookup.end() != cachedComponents)
+		{
+			for (auto &component : cachedComponents->second)
+			{
+				if (is_component_available(component.get()))
+				{
+					retVal = component;
+					break;
+				}
+			}
+		}
+
+		if (nullptr != retVal)
+		{
+			if (nullptr != retVal->getParentComponent())
+			{
+				// The component is being taken out of a cached tree that isn't shown right now, so that tree is no longer complete
+				erase_component_and_parents(cache, retVal->getParentComponent());
+			}
+		}
+		else
+		{
+			buildDepth++;
+			retVal = build_component(workingSet, sourceObject);
+			buildDepth--;
+
+			if (nullptr != retVal)
+			{
+				// Building children may have added to the cache, so look it up again
+				auto &updatedCache = get_cache(workingSet);
+				updatedCache.componentLookup[sourceObject->get_id()].push_back(retVal);
+				add_references(updatedCache, retVal.get());
+
+				if (isobus::VirtualTerminalObjectType::InputList == sourceObject->get_object_type())
+				{
+					auto variableReference = std::static_pointer_cast<isobus::InputList>(sourceObject)->get_variable_reference();
+
+					if (isobus::NULL_OBJECT_ID != variableReference)
+					{
+						updatedCache.dependentObjects[variableReference].insert(sourceObject->get_id());
+					}
+				}
+			}
+		}
+	}
+
+	if (nullptr != retVal)
+	{
+		componentsHandedOutThisBuild.insert(retVal.get());
+	}
+	return retVal;
+}
+
+void JuceManagedWorkingSetCache::invalidate_object(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID)
+{
+	for (auto &cache : workingSetComponentCache)
+	{
+		if (cache.workingSet == workingSet)
+		{
+			std::vector<std::uint16_t> objectsToInvalidate = { objectID };
+			std::set<std::uint16_t> invalidatedObjects;
+			cache.objectRevisions[objectID] = ++cache.revisionCounter;
+			cache.resolvedFonts.erase(objectID);
+
+			while (!objectsToInvalidate.empty())
+			{
+				auto currentObjectID = objectsToInvalidate.back();
+				objectsToInvalidate.pop_back();
+
+				if (!invalidatedObjects.insert(currentObjectID).second)
+				{
+					continue;
+				}
+				erase_decoded_pictures(cache, currentObjectID);
+				demote_static_layers(cache, currentObjectID);
+
+				auto cachedComponents = cache.componentLookup.find(currentObjectID);
+				if (cache.componentLookup.end() != cachedComponents)
+				{
+					// Copy the list, since erasing components modifies the lookup
+					auto instances = cachedComponents->second;
+
+					for (auto &instance : instances)
+					{
+						erase_component_and_parents(cache, instance.get());
+					}
+				}
+
+				auto dependents = cache.dependentObjects.find(currentObjectID);
+				if (cache.dependentObjects.end() != dependents)
+				{
+					objectsToInvalidate.insert(objectsToInvalidate.end(), dependents->second.begin(), dependents->second.end());
+					cache.dependentObjects.erase(dependents);
+				}
+			}
+			break;
+		}
+	}
+}
+
+bool JuceManagedWorkingSetCache::update_object(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID)
+{
+	bool retVal = true;
+
+	for (auto &cache : workingSetComponentCache)
+	{
+		if (cache.workingSet == workingSet)
+		{
+			auto sourceObject = workingSet->get_object_by_id(objectID);
+			auto cachedComponents = cache.componentLookup.find(objectID);
+			cache.objectRevisions[objectID] = ++cache.revisionCounter;
+			cache.resolvedFonts.erase(objectID);
+			erase_decoded_pictures(cache, objectID);
+			demote_static_layers(cache, objectID);
+
+			if (cache.componentLookup.end() != cachedComponents)
+			{
+				// Copy the list, since erasing components modifies the lookup
+				auto instances = cachedComponents->second;
+
+				for (auto &instance : instances)
+				{
+					if ((nullptr == sourceObject) || (!update_component_in_place(cache, *instance, sourceObject)))
+					{
+						if (is_component_in_use(instance.get()))
+						{
+							retVal = false;
+						}
+						erase_component_and_parents(cache, instance.get());
+					}
+				}
+			}
+
+			auto dependents = cache.dependentObjects.find(objectID);
+			if (cache.dependentObjects.end() != dependents)
+			{
+				auto dependentObjectIDs = dependents->second;
+
+				for (auto &dependentObjectID : dependentObjectIDs)
+				{
+					invalidate_object(workingSet, dependentObjectID);
+				}
+				retVal = false;
+			}
+
+			auto references = cache.referencingComponents.find(objectID);
+			if (cache.referencingComponents.end() != references)
+			{
+				for (auto &referencingComponent : references->second)
+				{
+					update_opacity(*referencingComponent);
+					referencingComponent->repaint();
+				}
+			}
+			break;
+		}
+	}
+	return retVal;
+}
+
+void JuceManagedWorkingSetCache::invalidate_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	for (auto &cache : workingSetComponentCache)
+	{
+		if (cache.workingSet == workingSet)
+		{
+			cache.componentLookup.clear();
+			cache.dependentObjects.clear();
+			cache.referencingComponents.clear();
+			cache.objectRevisions.clear();
+			cache.resolvedFonts.clear();
+			// Pictures bake in their transparency, and a new pool may reuse an ID and size for different picture data
+			cache.decodedPictures.clear();
+			cache.decodedPictureMemory = 0;
+			cache.workingSetRevision = ++cache.revisionCounter;
+			break;
+		}
+	}
+}
+
+void JuceManagedWorkingSetCache::invalidate_colours(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	for (auto &cache : workingSetComponentCache)
+	{
+		if (cache.workingSet == workingSet)
+		{
+			cache.colourTableOutdated = true;
+			break;
+		}
+	}
+}
+
+void JuceManagedWorkingSetCache::remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	for (auto cache = workingSetComponentCache.begin(); cache != workingSetComponentCache.end(); cache++)
+	{
+		if (cache->workingSet == workingSet)
+		{
+			if (0 != cache->decodedPictureMemory)
+			{
+				isobus::CANStackLogger::debug("[VT Server]: Released " + std::to_string(cache->decodedPictureMemory / 1024) + " KiB of decoded pictures for a disconnected working set");
+			}
+			workingSetComponentCache.erase(cache);
+			break;
+		}
+	}
+}
+
+void JuceManagedWorkingSetCache::clear()
+{
+	componentsHandedOutThisBuild.clear();
+	workingSetComponentCache.clear();
+}
+
+std::uint32_t JuceManagedWorkingSetCache::get_object_revision(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID)
+{
+	std::uint32_t retVal = 0;
+
+	for (auto &cache : workingSetComponentCache)
+	{
+		if (cache.workingSet == workingSet)
+		{
+			auto objectRevision = cache.objectRevisions.find(objectID);
+			retVal = (cache.objectRevisions.end() != objectRevision) ? objectRevision->second : cache.workingSetRevision;
+			break;
+		}
+	}
+	return retVal;
+}
+
+std::uint32_t JuceManagedWorkingSetCache::get_working_set_revision(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	std::uint32_t retVal = 0;
+
+	for (auto &cache : workingSetComponentCache)
+	{
+		if (cache.workingSet == workingSet)
+		{
+			retVal = cache.workingSetRevision;
+			break;
+		}
+	}
+	return retVal;
+}
+
+std::shared_ptr<const JuceManagedWorkingSetCache::ResolvedFont> JuceManagedWorkingSetCache::get_font(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t fontAttributesID)
+{
+	std::shared_ptr<const ResolvedFont> retVal;
+
+	if ((nullptr != workingSet) && (isobus::NULL_OBJECT_ID != fontAttributesID))
+	{
+		auto revision = get_object_revision(workingSet, fontAttributesID);
+		auto &cache = get_cache(workingSet);
+		auto resolvedFont = cache.resolvedFonts.find(fontAttributesID);
+
+		if ((cache.resolvedFonts.end() != resolvedFont) && (resolvedFont->second.first == revision))
+		{
+			retVal = resolvedFont->second.second;
+		}
+		else
+		{
+			auto object = workingSet->get_object_by_id(fontAttributesID);
+
+			if ((nullptr != object) && (isobus::VirtualTerminalObjectType::FontAttributes == object->get_object_type()))
+			{
+				auto fontAttributes = std::static_pointer_cast<isobus::FontAttributes>(object);
+				auto newFont = std::make_shared<ResolvedFont>();
+				int fontStyleFlags = Font::FontStyleFlags::plain;
+
+				if (fontAttributes->get_style(isobus::FontAttributes::FontStyleBits::Bold))
+				{
+					fontStyleFlags |= Font::FontStyleFlags::bold;
+				}
+
+				if (fontAttributes->get_style(isobus::FontAttributes::FontStyleBits::Italic))
+				{
+					fontStyleFlags |= Font::FontStyleFlags::italic;
+				}
+
+				if (fontAttributes->get_style(isobus::FontAttributes::FontStyleBits::Underlined))
+				{
+					fontStyleFlags |= Font::FontStyleFlags::underlined;
+				}
+
+				newFont->font = Font(Font::getDefaultMonospacedFontName(), fontAttributes->get_font_height_pixels(), fontStyleFlags);
+				newFont->font.setHorizontalScale(static_cast<float>(fontAttributes->get_font_width_pixels()) / newFont->font.getStringWidthFloat("a"));
+				newFont->plainFont = Font(Font::getDefaultMonospacedFontName(), fontAttributes->get_font_height_pixels(), Font::FontStyleFlags::plain);
+				newFont->plainFont.setHorizontalScale(static_cast<float>(fontAttributes->get_font_width_pixels()) / newFont->plainFont.getStringWidthFloat("1"));
+				newFont->colour = get_colour(workingSet, fontAttributes->get_colour());
+				newFont->type = fontAttributes->get_type();
+				newFont->widthPixels = fontAttributes->get_font_width_pixels();
+				newFont->inverted = fontAttributes->get_style(isobus::FontAttributes::FontStyleBits::Inverted);
+				newFont->flashing = fontAttributes->get_style(isobus::FontAttributes::FontStyleBits::Flashing);
+				newFont->flashingHidden = fontAttributes->get_style(isobus::FontAttributes::FontStyleBits::FlashingHidden);
+				retVal = newFont;
+			}
+			cache.resolvedFonts[fontAttributesID] = std::make_pair(revision, retVal);
+		}
+	}
+	return retVal;
+}
+
+std::shared_ptr<const JuceManagedWorkingSetCache::PackedColourTable> JuceManagedWorkingSetCache::get_packed_colour_table(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	auto &cache = get_cache(workingSet);
+	update_packed_colour_table(cache);
+	return cache.packedColourTable;
+}
+
+Colour JuceManagedWorkingSetCache::get_colour(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint8_t colourIndex)
+{
+	auto &cache = get_cache(workingSet);
+	update_packed_colour_table(cache);
+	return Colour((*cache.packedColourTable)[colourIndex]);
+}
+
+void JuceManagedWorkingSetCache::update_packed_colour_table(ComponentCacheClass &cache)
+{
+	if ((nullptr == cache.packedColourTable) || cache.colourTableOutdated)
+	{
+		auto colourTable = std::make_shared<PackedColourTable>();
+
+		for (std::size_t i = 0; i < colourTable->size(); i++)
+		{
+			auto vtColour = cache.workingSet->get_colour(static_cast<std::uint8_t>(i));
+			(*colourTable)[i] = Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f).getPixelARGB();
+		}
+
+		// A macro may select the colour map that is already active, so only start a new revision if the colours actually changed
+		if ((nullptr != cache.packedColourTable) &&
+		    (!std::equal(colourTable->begin(), colourTable->end(), cache.packedColourTable->begin(), [](const PixelARGB &first, const PixelARGB &second) { return first.getNativeARGB() == second.getNativeARGB(); })))
+		{
+			cache.colourTableRevision++;
+			cache.decodedPictures.clear();
+			cache.decodedPictureMemory = 0;
+		}
+		cache.packedColourTable = colourTable;
+		cache.colourTableOutdated = false;
+	}
+}
+
+Image JuceManagedWorkingSetCache::get_decoded_picture(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::PictureGraphic &picture)
+{
+	auto colourTable = get_packed_colour_table(workingSet);
+	auto &cache = get_cache(workingSet);
+	DecodedPictureKey key(picture.get_id(), picture.get_width(), picture.get_height(), cache.colourTableRevision);
+	auto decodedPicture = cache.decodedPictures.find(key);
+	Image retVal;
+
+	if (cache.decodedPictures.end() != decodedPicture)
+	{
+		retVal = decodedPicture->second;
+	}
+	else
+	{
+		retVal = PictureGraphicComponent::decode_image(picture, *colourTable);
+		cache.decodedPictures[key] = retVal;
+		cache.decodedPictureMemory += static_cast<std::size_t>(retVal.getWidth()) * static_cast<std::size_t>(retVal.getHeight()) * sizeof(PixelARGB);
+	}
+	return retVal;
+}
+
+void JuceManagedWorkingSetCache::predecode_pictures(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	auto colourTable = get_packed_colour_table(workingSet);
+	auto &cache = get_cache(workingSet);
+	std::vector<std::shared_ptr<isobus::PictureGraphic>> pictures;
+
+	for (const auto &object : workingSet->get_object_tree())
+	{
+		if ((nullptr != object.second) && (isobus::VirtualTerminalObjectType::PictureGraphic == object.second->get_object_type()))
+		{
+			pictures.push_back(std::static_pointer_cast<isobus::PictureGraphic>(object.second));
+		}
+	}
+
+	// Anything already in the cache may have been decoded from an older copy of the pool, so it's all replaced
+	cache.decodedPictures.clear();
+	cache.decodedPictureMemory = 0;
+
+	if (!pictures.empty())
+	{
+		std::vector<Image> decodedImages(pictures.size());
+		std::atomic<std::size_t> nextPicture(0);
+		const std::size_t hardwareThreads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+		const std::size_t numberOfThreads = std::min({ pictures.size(), hardwareThreads, MAX_PICTURE_DECODE_THREADS });
+		std::vector<std::thread> decodeThreads;
+
+		auto decodeWorker = [&pictures, &decodedImages, &nextPicture, &colourTable]() {
+			for (std::size_t i = nextPicture++; i < pictures.size(); i = nextPicture++)
+			{
+				decodedImages[i] = PictureGraphicComponent::decode_image(*pictures[i], *colourTable);
+			}
+		};
+
+		// The message thread helps out, so only start the extra threads
+		for (std::size_t i = 1; i < numberOfThreads; i++)
+		{
+			decodeThreads.emplace_back(decodeWorker);
+		}
+		decodeWorker();
+
+		for (auto &thread : decodeThreads)
+		{
+			thread.join();
+		}
+
+		for (std::size_t i = 0; i < pictures.size(); i++)
+		{
+			cache.decodedPictures[DecodedPictureKey(pictures[i]->get_id(), pictures[i]->get_width(), pictures[i]->get_height(), cache.colourTableRevision)] = decodedImages[i];
+			cache.decodedPictureMemory += static_cast<std::size_t>(decodedImages[i].getWidth()) * static_cast<std::size_t>(decodedImages[i].getHeight()) * sizeof(PixelARGB);
+		}
+		isobus::CANStackLogger::info("[VT Server]: Pre-decoded " + std::to_string(pictures.size()) + " pictures using " + std::to_string(numberOfThreads) + " threads, " + std::to_string(cache.decodedPictureMemory / 1024) + " KiB");
+	}
+}
+
+std::size_t JuceManagedWorkingSetCache::get_decoded_picture_memory_usage(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	std::size_t retVal = 0;
+
+	for (auto &cache : workingSetComponentCache)
+	{
+		if (cache.workingSet == workingSet)
+		{
+			retVal = cache.decodedPictureMemory;
+			break;
+		}
+	}
+	return retVal;
+}
+
+JuceManagedWorkingSetCache::ComponentCacheClass &JuceManagedWorkingSetCache::get_cache(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
 	for (auto &knownWorkingSet : workingSetComponentCache)
 	{
 		if (knownWorkingSet.workingSet == workingSet)
 		{
-			isWorkingSetKnown = true;
+			return knownWorkingSet;
+		}
+	}
+	workingSetComponentCache.emplace_back(workingSet);
+	return workingSetComponentCache.back();
+}
+
+bool JuceManagedWorkingSetCache::is_component_available(const Component *component)
+{
+	// A component can only have one parent, so only hand it out if it's not part of something that is
+	// already in use, or already part of the tree being built right now.
+	bool retVal = ((nullptr != component) && (!is_component_in_use(component)));
+
+	for (auto current = component; (nullptr != current) && retVal; current = current->getParentComponent())
+	{
+		if (0 != componentsHandedOutThisBuild.count(current))
+		{
+			retVal = false;
+		}
+	}
+	return retVal;
+}
+
+bool JuceManagedWorkingSetCache::is_component_in_use(const Component *component)
+{
+	bool retVal = false;
+
+	// Anything that isn't a VT object (like a render area) owns a tree that is in use
+	for (auto current = component; (nullptr != current) && (!retVal); current = current->getParentComponent())
+	{
+		retVal = (nullptr == dynamic_cast<const isobus::VTObject *>(current));
+	}
+	return retVal;
+}
+
+bool JuceManagedWorkingSetCache::update_component_in_place(ComponentCacheClass &cache, Component &component, std::shared_ptr<isobus::VTObject> sourceObject)
+{
+	bool retVal = false;
+
+	remove_references(cache, &component);
+
+	switch (sourceObject->get_object_type())
+	{
+		case isobus::VirtualTerminalObjectType::OutputString:
+		{
+			retVal = copy_object_state<isobus::OutputString>(component, sourceObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputString:
+		{
+			retVal = copy_object_state<isobus::InputString>(component, sourceObject);
+
+			if (retVal)
+			{
+				component.setOpaque(!std::static_pointer_cast<isobus::InputString>(sourceObject)->get_option(isobus::InputString::Options::Transparent));
+			}
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputNumber:
+		{
+			retVal = copy_object_state<isobus::OutputNumber>(component, sourceObject);
+
+			if (retVal)
+			{
+				component.setOpaque(!std::static_pointer_cast<isobus::OutputNumber>(sourceObject)->get_option(isobus::OutputNumber::Options::Transparent));
+			}
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputNumber:
+		{
+			retVal = copy_object_state<isobus::InputNumber>(component, sourceObject);
+
+			if (retVal)
+			{
+				component.setOpaque(!std::static_pointer_cast<isobus::InputNumber>(sourceObject)->get_option(isobus::InputNumber::Options::Transparent));
+			}
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputBoolean:
+		{
+			retVal = copy_object_state<isobus::InputBoolean>(component, sourceObject);
+
+			if (retVal)
+			{
+				component.setEnabled(std::static_pointer_cast<isobus::InputBoolean>(sourceObject)->get_enabled());
+			}
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLine:
+		{
+			retVal = copy_object_state<isobus::OutputLine>(component, sourceObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputRectangle:
+		{
+			retVal = copy_object_state<isobus::OutputRectangle>(component, sourceObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputEllipse:
+		{
+			retVal = copy_object_state<isobus::OutputEllipse>(component, sourceObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputPolygon:
+		{
+			retVal = copy_object_state<isobus::OutputPolygon>(component, sourceObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputMeter:
+		{
+			retVal = copy_object_state<isobus::OutputMeter>(component, sourceObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLinearBarGraph:
+		{
+			retVal = copy_object_state<isobus::OutputLinearBarGraph>(component, sourceObject);
+		}
+		break;
+
+		default:
+		{
+			// Everything else builds child components or other state from its object when it is constructed
+		}
+		break;
+	}
+
+	if (retVal)
+	{
+		component.setSize(sourceObject->get_width(), sourceObject->get_height());
+		add_references(cache, &component);
+		update_opacity(component);
+		component.repaint();
+	}
+	return retVal;
+}
+
+std::vector<std::uint16_t> JuceManagedWorkingSetCache::get_referenced_objects(const isobus::VTObject &object)
+{
+	std::vector<std::uint16_t> retVal;
+
+	switch (object.get_object_type())
+	{
+		case isobus::VirtualTerminalObjectType::OutputString:
+		{
+			auto &outputString = static_cast<const isobus::OutputString &>(object);
+			retVal = { outputString.get_variable_reference(), outputString.get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputString:
+		{
+			auto &inputString = static_cast<const isobus::InputString &>(object);
+			retVal = { inputString.get_variable_reference(), inputString.get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputNumber:
+		{
+			auto &outputNumber = static_cast<const isobus::OutputNumber &>(object);
+			retVal = { outputNumber.get_variable_reference(), outputNumber.get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputNumber:
+		{
+			auto &inputNumber = static_cast<const isobus::InputNumber &>(object);
+			retVal = { inputNumber.get_variable_reference(), inputNumber.get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputBoolean:
+		{
+			auto &inputBoolean = static_cast<const isobus::InputBoolean &>(object);
+			retVal = { inputBoolean.get_variable_reference(), inputBoolean.get_foreground_colour_object_id() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLine:
+		{
+			retVal = { static_cast<const isobus::OutputLine &>(object).get_line_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputRectangle:
+		{
+			auto &rectangle = static_cast<const isobus::OutputRectangle &>(object);
+			retVal = { rectangle.get_line_attributes(), rectangle.get_fill_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputEllipse:
+		{
+			auto &ellipse = static_cast<const isobus::OutputEllipse &>(object);
+			retVal = { ellipse.get_line_attributes(), ellipse.get_fill_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputPolygon:
+		{
+			auto &polygon = static_cast<const isobus::OutputPolygon &>(object);
+			retVal = { polygon.get_line_attributes(), polygon.get_fill_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputMeter:
+		{
+			retVal = { static_cast<const isobus::OutputMeter &>(object).get_variable_reference() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLinearBarGraph:
+		{
+			retVal = { static_cast<const isobus::OutputLinearBarGraph &>(object).get_variable_reference() };
+		}
+		break;
+
+		default:
+		{
+		}
+		break;
+	}
+
+	retVal.erase(std::remove(retVal.begin(), retVal.end(), isobus::NULL_OBJECT_ID), retVal.end());
+	return retVal;
+}
+
+void JuceManagedWorkingSetCache::add_references(ComponentCacheClass &cache, Component *component)
+{
+	auto vtObject = dynamic_cast<const isobus::VTObject *>(component);
+
+	if (nullptr != vtObject)
+	{
+		for (auto &referencedObjectID : get_referenced_objects(*vtObject))
+		{
+			cache.referencingComponents[referencedObjectID].push_back(component);
+		}
+	}
+}
+
+void JuceManagedWorkingSetCache::remove_references(ComponentCacheClass &cache, const Component *component)
+{
+	auto vtObject = dynamic_cast<const isobus::VTObject *>(component);
+
+	if (nullptr != vtObject)
+	{
+		for (auto &referencedObjectID : get_referenced_objects(*vtObject))
+		{
+			auto references = cache.referencingComponents.find(referencedObjectID);
+
+			if (cache.referencingComponents.end() != references)
+			{
+				auto &components = references->second;
+				components.erase(std::remove(components.begin(), components.end(), component), components.end());
+
+				if (components.empty())
+				{
+					cache.referencingComponents.erase(references);
+				}
+			}
+		}
+	}
+}
+
+void JuceManagedWorkingSetCache::erase_component_and_parents(ComponentCacheClass &cache, Component *component)
+{
+	std::vector<const Component *> componentsToErase;
+
+	for (auto current = component; (nullptr != current) && (nullptr != dynamic_cast<isobus::VTObject *>(current)); current = current->getParentComponent())
+	{
+		componentsToErase.push_back(current);
+	}
+
+	for (auto &componentToErase : componentsToErase)
+	{
+		erase_component(cache, componentToErase);
+	}
+}
+
+void JuceManagedWorkingSetCache::erase_component(ComponentCacheClass &cache, const Component *component)
+{
+	auto vtObject = dynamic_cast<const isobus::VTObject *>(component);
+
+	if (nullptr != vtObject)
+	{
+		auto cachedComponents = cache.componentLookup.find(vtObject->get_id());
+
+		if (cache.componentLookup.end() != cachedComponents)
+		{
+			auto &instances = cachedComponents->second;
+			auto found = std::find_if(instances.begin(), instances.end(), [component](const std::shared_ptr<Component> &instance) { return instance.get() == component; });
+
+			if (instances.end() != found)
+			{
+				remove_references(cache, component);
+
+				// Keep the component alive until the lookup is consistent again, destroying it can release other cached components
+				auto erasedComponent = *found;
+				instances.erase(found);
+
+				if (instances.empty())
+				{
+					cache.componentLookup.erase(cachedComponents);
+				}
+			}
+		}
+	}
+}
+
+void JuceManagedWorkingSetCache::erase_decoded_pictures(ComponentCacheClass &cache, std::uint16_t objectID)
+{
+	// Keys are sorted by object ID first, so all of this object's pictures are next to each other
+	auto decodedPicture = cache.decodedPictures.lower_bound(DecodedPictureKey(objectID, 0, 0, 0));
+
+	while ((cache.decodedPictures.end() != decodedPicture) && (std::get<0>(decodedPicture->first) == objectID))
+	{
+		cache.decodedPictureMemory -= static_cast<std::size_t>(decodedPicture->second.getWidth()) * static_cast<std::size_t>(decodedPicture->second.getHeight()) * sizeof(PixelARGB);
+		decodedPicture = cache.decodedPictures.erase(decodedPicture);
+	}
+}
+
+void JuceManagedWorkingSetCache::update_opacity(Component &component)
+{
+	// Only these work out their opacity from other objects, everything else sets it when it is built or updated
+	auto rectangle = dynamic_cast<OutputRectangleComponent *>(&component);
+	auto outputString = dynamic_cast<OutputStringComponent *>(&component);
+
+	if (nullptr != rectangle)
+	{
+		rectangle->update_opacity();
+	}
+	else if (nullptr != outputString)
+	{
+		outputString->update_opacity();
+	}
+}
+
+void JuceManagedWorkingSetCache::demote_static_layers(ComponentCacheClass &cache, std::uint16_t objectID)
+{
+	std::vector<Component *> affectedComponents;
+	cache.volatileObjects.insert(objectID);
+
+	auto cachedComponents = cache.componentLookup.find(objectID);
+	if (cache.componentLookup.end() != cachedComponents)
+	{
+		for (auto &instance : cachedComponents->second)
+		{
+			affectedComponents.push_back(instance.get());
+		}
+	}
+
+	auto references = cache.referencingComponents.find(objectID);
+	if (cache.referencingComponents.end() != references)
+	{
+		affectedComponents.insert(affectedComponents.end(), references->second.begin(), references->second.end());
+	}
+
+	// Repainting already refreshes a buffered parent's image, but an object that changes once will likely change again,
+	// so stop re-rendering the whole layer around it every time
+	for (auto &affectedComponent : affectedComponents)
+	{
+		for (auto current = affectedComponent; (nullptr != current) && (nullptr != dynamic_cast<isobus::VTObject *>(current)); current = current->getParentComponent())
+		{
+			if (nullptr != current->getCachedComponentImage())
+			{
+				current->setBufferedToImage(false);
+			}
+		}
+	}
+}
+
+bool JuceManagedWorkingSetCache::is_static_component(const ComponentCacheClass &cache, const Component &component)
+{
+	bool retVal = false;
+	auto vtObject = dynamic_cast<const isobus::VTObject *>(&component);
+
+	if ((nullptr != vtObject) &&
+	    (cache.volatileObjects.end() == cache.volatileObjects.find(vtObject->get_id())) &&
+	    (!FlashScheduler::is_subscribed(&component)))
+	{
+		switch (vtObject->get_object_type())
+		{
+			// The user can change these without the working set sending a command
+			case isobus::VirtualTerminalObjectType::Button:
+			case isobus::VirtualTerminalObjectType::Key:
+			case isobus::VirtualTerminalObjectType::InputBoolean:
+			case isobus::VirtualTerminalObjectType::InputString:
+			case isobus::VirtualTerminalObjectType::InputNumber:
+			case isobus::VirtualTerminalObjectType::InputList:
+			{
+				retVal = false;
+			}
+			break;
+
+			default:
+			{
+				retVal = true;
+
+				for (auto &referencedObjectID : get_referenced_objects(*vtObject))
+				{
+					auto referencedObject = cache.workingSet->get_object_by_id(referencedObjectID);
+
+					if ((cache.volatileObjects.end() != cache.volatileObjects.find(referencedObjectID)) ||
+					    ((nullptr != referencedObject) &&
+					     ((isobus::VirtualTerminalObjectType::NumberVariable == referencedObject->get_object_type()) ||
+					      (isobus::VirtualTerminalObjectType::StringVariable == referencedObject->get_object_type()))))
+					{
+						retVal = false;
+						break;
+					}
+				}
+			}
 			break;
 		}
 	}
+	return retVal;
+}
+
+bool JuceManagedWorkingSetCache::find_static_layers(const ComponentCacheClass &cache, Component &component, std::set<const Component *> &layers)
+{
+	bool retVal = is_static_component(cache, component);
+	std::vector<const Component *> staticChildren;
+
+	for (auto child : component.getChildren())
+	{
+		if (find_static_layers(cache, *child, layers))
+		{
+			if (child->getNumChildComponents() > 0)
+			{
+				staticChildren.push_back(child);
+			}
+		}
+		else
+		{
+			retVal = false;
+		}
+	}
+
+	if (!retVal)
+	{
+		// This component changes, so each static subtree below it becomes its own layer.
+		// Single objects draw about as quickly as their image would, so only groups are worth buffering.
+		layers.insert(staticChildren.begin(), staticChildren.end());
+	}
+	return retVal;
+}
+
+void JuceManagedWorkingSetCache::apply_static_layers(Component &component, const std::set<const Component *> &layers)
+{
+	const bool shouldBuffer = (layers.end() != layers.find(&component));
+
+	if (shouldBuffer != (nullptr != component.getCachedComponentImage()))
+	{
+		component.setBufferedToImage(shouldBuffer);
+	}
 
-	if (!isWorkingSetKnown)
+	for (auto child : component.getChildren())
 	{
-		workingSetComponentCache.emplace_back(workingSet);
+		apply_static_layers(*child, layers);
 	}
+}
+
+std::shared_ptr<Component> JuceManagedWorkingSetCache::build_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> sourceObject)
+{
+	std::shared_ptr<Component> retVal;
 
 	if (nullptr != sourceObject)
 	{
@@ -230,7 +1157,30 @@ std::shared_ptr<Component> JuceManagedWorkingSetCache::create_component(std::sha
 	return retVal;
 }
 
+void JuceManagedWorkingSetCache::update_static_layers(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, Component &root)
+{
+	if (nullptr != workingSet)
+	{
+		const auto &cache = get_cache(workingSet);
+		std::set<const Component *> layers;
+
+		if (find_static_layers(cache, root, layers) && (root.getNumChildComponents() > 0))
+		{
+			layers.insert(&root);
+		}
+		apply_static_layers(root, layers);
+	}
+}
+
 void JuceManagedWorkingSetCache::set_softkey_mask_dimension_info(const SoftKeyMaskDimensions &info)
 {
 	softKeyDimensionInfo = info;
+
+	// Cached keys and soft key masks were sized with the old dimensions
+	for (auto &cache : workingSetComponentCache)
+	{
+		cache.componentLookup.clear();
+		cache.dependentObjects.clear();
+		cache.referencingComponents.clear();
+	}
 }
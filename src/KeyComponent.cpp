@@ -6,6 +6,7 @@
 #include "KeyComponent.hpp"
 
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 KeyComponent::KeyComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::Key sourceObject, int keyWidth, int keyHeight) :
   isobus::Key(sourceObject),
@@ -33,7 +34,9 @@ KeyComponent::KeyComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedW
 
 void KeyComponent::paint(Graphics &g)
 {
-	auto vtColour = parentWorkingSet->get_colour(backgroundColor);
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
 
-	g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+	auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, backgroundColor);
+
+	g.fillAll(vtColour);
 }
@@ -0,0 +1,80 @@
+/*******************************************************************************
+** @file       MaskRasterizer.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "MaskRasterizer.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
+
+#include "isobus/isobus/can_stack_logger.hpp"
+
+Image MaskRasterizer::render_to_image(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID, float scale)
+{
+	Image retVal;
+
+	if ((nullptr != workingSet) && (scale > 0.0f))
+	{
+		auto object = workingSet->get_object_by_id(objectID);
+		auto component = JuceManagedWorkingSetCache::create_component(workingSet, object);
+
+		if ((nullptr != component) && (!component->getLocalBounds().isEmpty()))
+		{
+			// Always use the software renderer, since native image types may need a display or GPU context
+			retVal = Image(Image::PixelFormat::ARGB,
+			               roundToInt(static_cast<float>(component->getWidth()) * scale),
+			               roundToInt(static_cast<float>(component->getHeight()) * scale),
+			               true,
+			               SoftwareImageType());
+
+			Graphics g(retVal);
+			g.addTransform(AffineTransform::scale(scale));
+			component->paintEntireComponent(g, false);
+#ifdef AGISOVT_PAINT_PROFILING
+			PaintProfiler::end_frame();
+#endif
+		}
+		else
+		{
+			isobus::CANStackLogger::warn("[VT Server]: Can't render object " + std::to_string(objectID) + ", it doesn't exist or isn't drawable");
+		}
+	}
+	return retVal;
+}
+
+MaskRasterizer::RGBAImage MaskRasterizer::render_to_rgba(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID, float scale)
+{
+	return convert_to_rgba(render_to_image(workingSet, objectID, scale));
+}
+
+MaskRasterizer::RGBAImage MaskRasterizer::convert_to_rgba(const Image &image)
+{
+	RGBAImage retVal;
+
+	if (image.isValid())
+	{
+		const auto argbImage = image.convertedToFormat(Image::PixelFormat::ARGB);
+		const Image::BitmapData bitmapData(argbImage, Image::BitmapData::readOnly);
+
+		retVal.width = argbImage.getWidth();
+		retVal.height = argbImage.getHeight();
+		retVal.pixels.resize(static_cast<std::size_t>(retVal.width) * static_cast<std::size_t>(retVal.height) * 4);
+
+		auto destination = retVal.pixels.data();
+
+		for (int y = 0; y < retVal.height; y++)
+		{
+			for (int x = 0; x < retVal.width; x++)
+			{
+				// JUCE stores premultiplied pixels in native byte order
+				auto pixel = *reinterpret_cast<const PixelARGB *>(bitmapData.getPixelPointer(x, y));
+				pixel.unpremultiply();
+				*destination++ = pixel.getRed();
+				*destination++ = pixel.getGreen();
+				*destination++ = pixel.getBlue();
+				*destination++ = pixel.getAlpha();
+			}
+		}
+	}
+	return retVal;
+}
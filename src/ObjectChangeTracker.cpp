@@ -0,0 +1,205 @@
+/*******************************************************************************
+** @file       ObjectChangeTracker.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "ObjectChangeTracker.hpp"
+
+#include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
+
+void ObjectChangeTracker::process_ecu_to_vt_message(const isobus::CANMessage &message)
+{
+	auto client = message.get_source_control_function();
+
+	if ((nullptr == client) || (0 == message.get_data_length()))
+	{
+		return;
+	}
+
+	std::uint16_t changedObjectID = isobus::NULL_OBJECT_ID;
+	bool fullRefreshNeeded = false;
+	bool coloursChanged = false;
+
+	switch (static_cast<Function>(message.get_uint8_at(0)))
+	{
+		case Function::HideShowObjectCommand:
+		case Function::EnableDisableObjectCommand:
+		case Function::SelectInputObjectCommand:
+		case Function::ChangeSizeCommand:
+		case Function::ChangeBackgroundColourCommand:
+		case Function::ChangeNumericValueCommand:
+		case Function::ChangeEndPointCommand:
+		case Function::ChangeFontAttributesCommand:
+		case Function::ChangeLineAttributesCommand:
+		case Function::ChangeFillAttributesCommand:
+		case Function::ChangeAttributeCommand:
+		case Function::ChangePriorityCommand:
+		case Function::ChangeListItemCommand:
+		case Function::ChangeStringValueCommand:
+		case Function::ChangeObjectLabelCommand:
+		case Function::ChangePolygonPointCommand:
+		case Function::ChangePolygonScaleCommand:
+		case Function::GraphicsContextCommand:
+		case Function::ChangeChildLocationCommand: // Child locations are stored in the parent, which is in bytes 1 and 2
+		case Function::ChangeChildPositionCommand:
+		{
+			if (message.get_data_length() >= 3)
+			{
+				changedObjectID = message.get_uint16_at(1);
+			}
+			else
+			{
+				fullRefreshNeeded = true;
+			}
+		}
+		break;
+
+		case Function::ChangeSoftKeyMaskCommand:
+		{
+			if (message.get_data_length() >= 4)
+			{
+				changedObjectID = message.get_uint16_at(2);
+			}
+			else
+			{
+				fullRefreshNeeded = true;
+			}
+		}
+		break;
+
+		// These can all replace the colour map or colour palette, either directly or by changing the pool
+		case Function::ObjectPoolTransferMessage:
+		case Function::EndOfObjectPoolMessage:
+		case Function::DeleteObjectPoolCommand:
+		case Function::SelectColourMapCommand:
+		case Function::ExecuteExtendedMacroCommand:
+		case Function::ExecuteMacroCommand:
+		case Function::LoadVersionCommand:
+		case Function::ExtendedLoadVersionCommand:
+		{
+			fullRefreshNeeded = true;
+			coloursChanged = true;
+		}
+		break;
+
+		// These don't change any objects. Mask changes are handled by the active mask event.
+		case Function::ESCCommand:
+		case Function::ControlAudioSignalCommand:
+		case Function::SetAudioVolumeCommand:
+		case Function::ChangeActiveMaskCommand:
+		case Function::GetAttributeValueMessage:
+		case Function::IdentifyVTMessage:
+		case Function::LockUnlockMaskCommand:
+		case Function::GetMemoryMessage:
+		case Function::GetSupportedWidecharsMessage:
+		case Function::GetNumberOfSoftKeysMessage:
+		case Function::GetTextFontDataMessage:
+		case Function::GetWindowMaskDataMessage:
+		case Function::GetSupportedObjectsMessage:
+		case Function::GetHardwareMessage:
+		case Function::StoreVersionCommand:
+		case Function::DeleteVersionCommand:
+		case Function::ExtendedGetVersionsMessage:
+		case Function::ExtendedStoreVersionCommand:
+		case Function::ExtendedDeleteVersionCommand:
+		case Function::GetVersionsMessage:
+		case Function::UnsupportedVTFunctionMessage:
+		case Function::VTStatusMessage:
+		case Function::WorkingSetMaintenanceMessage:
+		{
+		}
+		break;
+
+		default:
+		{
+			// We don't know what this does, so be safe
+			fullRefreshNeeded = true;
+			coloursChanged = true;
+		}
+		break;
+	}
+
+	if ((isobus::NULL_OBJECT_ID != changedObjectID) || fullRefreshNeeded)
+	{
+		const std::lock_guard<std::mutex> lock(changesMutex);
+		auto &changes = clientChanges[client];
+
+		if (isobus::NULL_OBJECT_ID != changedObjectID)
+		{
+			changes.pending.changedObjects.insert(changedObjectID);
+		}
+		changes.pending.fullRefreshNeeded |= fullRefreshNeeded;
+		changes.pending.coloursChanged |= coloursChanged;
+	}
+}
+
+void ObjectChangeTracker::on_repaint_requested(std::shared_ptr<isobus::ControlFunction> client)
+{
+	const std::lock_guard<std::mutex> lock(changesMutex);
+	auto &changes = clientChanges[client];
+
+	changes.ready.repaintRequests++;
+
+	if (changes.pending.changedObjects.empty() && !changes.pending.fullRefreshNeeded)
+	{
+		changes.ready.fullRefreshNeeded = true;
+		changes.ready.coloursChanged = true;
+	}
+	else
+	{
+		changes.ready.changedObjects.insert(changes.pending.changedObjects.begin(), changes.pending.changedObjects.end());
+		changes.ready.fullRefreshNeeded |= changes.pending.fullRefreshNeeded;
+		changes.ready.coloursChanged |= changes.pending.coloursChanged;
+		changes.pending = ChangeSet();
+	}
+}
+
+void ObjectChangeTracker::request_full_refresh(std::shared_ptr<isobus::ControlFunction> client)
+{
+	const std::lock_guard<std::mutex> lock(changesMutex);
+	clientChanges[client].ready.fullRefreshNeeded = true;
+	clientChanges[client].ready.coloursChanged = true;
+}
+
+bool ObjectChangeTracker::has_changes(std::shared_ptr<isobus::ControlFunction> client)
+{
+	bool retVal = false;
+	const std::lock_guard<std::mutex> lock(changesMutex);
+	auto changes = clientChanges.find(client);
+
+	if (clientChanges.end() != changes)
+	{
+		retVal = ((!changes->second.ready.changedObjects.empty()) ||
+		          changes->second.ready.fullRefreshNeeded ||
+		          changes->second.ready.coloursChanged);
+	}
+	return retVal;
+}
+
+ObjectChangeTracker::ChangeSet ObjectChangeTracker::take_changes(std::shared_ptr<isobus::ControlFunction> client)
+{
+	ChangeSet retVal;
+	const std::lock_guard<std::mutex> lock(changesMutex);
+	auto changes = clientChanges.find(client);
+
+	if (clientChanges.end() != changes)
+	{
+		retVal = std::move(changes->second.ready);
+		changes->second.ready = ChangeSet();
+	}
+	return retVal;
+}
+
+void ObjectChangeTracker::remove_client(std::shared_ptr<isobus::ControlFunction> client)
+{
+	const std::lock_guard<std::mutex> lock(changesMutex);
+	clientChanges.erase(client);
+}
+
+void ObjectChangeTracker::process_rx_message(const isobus::CANMessage &message, void *parentPointer)
+{
+	if (nullptr != parentPointer)
+	{
+		static_cast<ObjectChangeTracker *>(parentPointer)->process_ecu_to_vt_message(message);
+	}
+}
@@ -5,6 +5,7 @@
 *******************************************************************************/
 #include "ObjectPointerComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 ObjectPointerComponent::ObjectPointerComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::ObjectPointer sourceObject) :
   isobus::ObjectPointer(sourceObject),
@@ -49,6 +50,7 @@ void ObjectPointerComponent::on_content_changed(bool initial)
 
 void ObjectPointerComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
 }
 
 void ObjectPointerComponent::getChildSizeRecursive(int &w, int &h) const
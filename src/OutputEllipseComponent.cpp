@@ -5,6 +5,7 @@
 *******************************************************************************/
 #include "OutputEllipseComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 OutputEllipseComponent::OutputEllipseComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::OutputEllipse sourceObject) :
   isobus::OutputEllipse(sourceObject),
@@ -15,192 +16,212 @@ OutputEllipseComponent::OutputEllipseComponent(std::shared_ptr<isobus::VirtualTe
 
 void OutputEllipseComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	bool fillNeeded = false;
 	bool useLineColourForFill = false;
-	isobus::VTColourVector fillColour;
+	Colour fillColour = Colours::black;
 	// Ensure we fill first, then draw the outline if needed
-	if (isobus::NULL_OBJECT_ID != get_fill_attributes())
+	auto fill = fillAttributes.get(parentWorkingSet, get_fill_attributes(), isobus::VirtualTerminalObjectType::FillAttributes);
+	if (nullptr != fill)
 	{
-		auto child = get_object_by_id(get_fill_attributes(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::FillAttributes == child->get_object_type()))
+		if (fill->get_type() != isobus::FillAttributes::FillType::NoFill)
 		{
-			auto fill = std::static_pointer_cast<isobus::FillAttributes>(child);
-			if (fill->get_type() != isobus::FillAttributes::FillType::NoFill)
+			if (fill->get_type() == isobus::FillAttributes::FillType::FillWithSpecifiedColorInFillColorAttribute)
 			{
-				if (fill->get_type() == isobus::FillAttributes::FillType::FillWithSpecifiedColorInFillColorAttribute)
-				{
-					fillColour = parentWorkingSet->get_colour(fill->get_background_color());
-				}
-				else if (fill->get_type() == isobus::FillAttributes::FillType::FillWithLineColor)
-				{
-					useLineColourForFill = true;
-				}
-				else if (fill->get_type() == isobus::FillAttributes::FillType::FillWithPatternGivenByFillPatternAttribute)
-				{
-					// @todo
-				}
-				fillNeeded = true;
+				fillColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, fill->get_background_color());
+			}
+			else if (fill->get_type() == isobus::FillAttributes::FillType::FillWithLineColor)
+			{
+				useLineColourForFill = true;
+			}
+			else if (fill->get_type() == isobus::FillAttributes::FillType::FillWithPatternGivenByFillPatternAttribute)
+			{
+				// @todo
 			}
+			fillNeeded = true;
 		}
 	}
 
-	if (isobus::NULL_OBJECT_ID != get_line_attributes())
+	auto line = lineAttributes.get(parentWorkingSet, get_line_attributes(), isobus::VirtualTerminalObjectType::LineAttributes);
+	if (nullptr != line)
 	{
-		auto child = get_object_by_id(get_line_attributes(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::LineAttributes == child->get_object_type()))
+		auto lineColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, line->get_background_color());
+		if (useLineColourForFill)
 		{
-			auto line = std::static_pointer_cast<isobus::LineAttributes>(child);
-
-			auto lineColour = parentWorkingSet->get_colour(line->get_background_color());
-			if (useLineColourForFill)
-			{
-				fillColour = lineColour;
-			}
+			fillColour = lineColour;
+		}
 
-			float centerX = get_width() / 2.0f;
-			float centerY = get_height() / 2.0f;
+		float centerX = get_width() / 2.0f;
+		float centerY = get_height() / 2.0f;
 
-			if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::Closed)
+		if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::Closed)
+		{
+			if (get_start_angle() == get_end_angle() && get_ellipse_type() != isobus::OutputEllipse::EllipseType::Closed)
 			{
-				if (get_start_angle() == get_end_angle() && get_ellipse_type() != isobus::OutputEllipse::EllipseType::Closed)
+				/* B.10 / Table B.31 / Ellipse type / NOTE 2:
+				 * If type = closed ellipse segment and start and end angle are the same, a
+				 * single line with width = border width shall be drawn from the centre point to the
+				 * point on the border defined by the start and end angles.*/
+				auto angleRadians = degreesToRadians(-((get_start_angle() * 2.0f) - 90));
+				if (angleRadians < 0)
 				{
-					/* B.10 / Table B.31 / Ellipse type / NOTE 2:
-					 * If type = closed ellipse segment and start and end angle are the same, a
-					 * single line with width = border width shall be drawn from the centre point to the
-					 * point on the border defined by the start and end angles.*/
-					auto angleRadians = degreesToRadians(-((get_start_angle() * 2.0f) - 90));
-					if (angleRadians < 0)
-					{
-						angleRadians += juce::MathConstants<float>().twoPi;
-					}
-
-					auto pointX = (centerX + (centerX - (line->get_width() / 2.0f)) * std::cos(angleRadians));
-					auto pointY = (centerY - (centerY - (line->get_height() / 2.0f)) * std::sin(angleRadians));
-
-					g.setColour(Colour::fromFloatRGBA(lineColour.r, lineColour.g, lineColour.b, 1.0f));
-					g.drawLine(centerX, centerY, pointX, pointY, line->get_width());
-				}
-				else
-				{
-					if (fillNeeded)
-					{
-						g.setColour(Colour::fromFloatRGBA(fillColour.r, fillColour.g, fillColour.b, 1.0f));
-						g.fillEllipse(0, 0, get_width(), get_height());
-					}
-					/* If type > 0 (!= Closed) and start and end angles are the same, the ellipse is drawn closed. */
-					g.setColour(Colour::fromFloatRGBA(lineColour.r, lineColour.g, lineColour.b, 1.0f));
-					g.drawEllipse(line->get_width() / 2.0f, line->get_width() / 2.0f, get_width() - line->get_width(), get_height() - line->get_width(), line->get_width());
+					angleRadians += juce::MathConstants<float>().twoPi;
 				}
+
+				auto pointX = (centerX + (centerX - (line->get_width() / 2.0f)) * std::cos(angleRadians));
+				auto pointY = (centerY - (centerY - (line->get_height() / 2.0f)) * std::sin(angleRadians));
+
+				g.setColour(lineColour);
+				g.drawLine(centerX, centerY, pointX, pointY, line->get_width());
 			}
 			else
 			{
-				// Juce coordinate system 0° is at the Y axis positive, calculating clockwise
-				// IsoBus coordinate system 0° is at the X axis positive, calculating counter-clockwise
-				float startAngle = juce::degreesToRadians(((get_start_angle() * 2.0f)));
-				float endAngle = juce::degreesToRadians(((get_end_angle() * 2.0f)));
-
-				juce::Path arcPath;
-				if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::ClosedEllipseSegment)
+				if (fillNeeded)
 				{
-					// segment: the ellipse section endpoints connected to the center with two lines
-					arcPath.startNewSubPath(centerX, centerY);
+					g.setColour(fillColour);
+					g.fillEllipse(0, 0, get_width(), get_height());
 				}
+				/* If type > 0 (!= Closed) and start and end angles are the same, the ellipse is drawn closed. */
+				g.setColour(lineColour);
+				g.drawEllipse(line->get_width() / 2.0f, line->get_width() / 2.0f, get_width() - line->get_width(), get_height() - line->get_width(), line->get_width());
+			}
+		}
+		else
+		{
+			ArcKey currentKey;
+			currentKey.width = get_width();
+			currentKey.height = get_height();
+			currentKey.startAngle = get_start_angle();
+			currentKey.endAngle = get_end_angle();
+			currentKey.type = get_ellipse_type();
+			currentKey.lineWidth = line->get_width();
+
+			if ((!arcValid) || (!(currentKey == arcKey)))
+			{
+				arcKey = currentKey;
+				update_arc(currentKey.lineWidth);
+				arcValid = true;
+			}
 
-				float wOffset = line->get_width() / 2.0f;
-
-				addArcToPath(arcPath, wOffset, wOffset, get_width() - line->get_width(), get_height() - line->get_width(), startAngle, endAngle, get_ellipse_type() != isobus::OutputEllipse::EllipseType::ClosedEllipseSegment);
-
-				if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::ClosedEllipseSegment)
-				{
-					// segment: the ellipse section endpoints connected to the center with two lines
-					arcPath.lineTo(centerX, centerY);
-					if (fillNeeded)
-					{
-						g.setColour(Colour::fromFloatRGBA(fillColour.r, fillColour.g, fillColour.b, 1.0f));
-						g.fillPath(arcPath);
-					}
-
-					g.setColour(Colour::fromFloatRGBA(lineColour.r, lineColour.g, lineColour.b, 1.0f));
-					g.strokePath(arcPath, juce::PathStrokeType(line->get_width()));
-				}
-				else if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::ClosedEllipseSection)
-				{
-					// section: the ellipse section endpoints connected with a straight line
-					arcPath.closeSubPath();
-					if (fillNeeded)
-					{
-						g.setColour(Colour::fromFloatRGBA(fillColour.r, fillColour.g, fillColour.b, 1.0f));
-						g.fillPath(arcPath);
-					}
-
-					g.setColour(Colour::fromFloatRGBA(lineColour.r, lineColour.g, lineColour.b, 1.0f));
-					g.strokePath(arcPath, juce::PathStrokeType(line->get_width()));
-				}
-				else if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::OpenDefinedByStartEndAngles)
-				{
-					g.setColour(Colour::fromFloatRGBA(lineColour.r, lineColour.g, lineColour.b, 1.0f));
-					g.strokePath(arcPath, juce::PathStrokeType(line->get_width()));
-				}
+			if (fillNeeded && (get_ellipse_type() != isobus::OutputEllipse::EllipseType::OpenDefinedByStartEndAngles))
+			{
+				g.setColour(fillColour);
+				g.fillPath(arcPath);
 			}
+			g.setColour(lineColour);
+			g.fillPath(arcOutline);
 		}
 	}
 }
 
+bool OutputEllipseComponent::ArcKey::operator==(const ArcKey &other) const
+{
+	return ((width == other.width) &&
+	        (height == other.height) &&
+	        (startAngle == other.startAngle) &&
+	        (endAngle == other.endAngle) &&
+	        (type == other.type) &&
+	        (lineWidth == other.lineWidth));
+}
+
+void OutputEllipseComponent::update_arc(std::uint16_t lineWidth)
+{
+	float centerX = get_width() / 2.0f;
+	float centerY = get_height() / 2.0f;
+
+	// Juce coordinate system 0° is at the Y axis positive, calculating clockwise
+	// IsoBus coordinate system 0° is at the X axis positive, calculating counter-clockwise
+	float startAngle = juce::degreesToRadians(((get_start_angle() * 2.0f)));
+	float endAngle = juce::degreesToRadians(((get_end_angle() * 2.0f)));
+
+	arcPath.clear();
+	if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::ClosedEllipseSegment)
+	{
+		// segment: the ellipse section endpoints connected to the center with two lines
+		arcPath.startNewSubPath(centerX, centerY);
+	}
+
+	float wOffset = lineWidth / 2.0f;
+
+	addArcToPath(arcPath, wOffset, wOffset, get_width() - lineWidth, get_height() - lineWidth, startAngle, endAngle, get_ellipse_type() != isobus::OutputEllipse::EllipseType::ClosedEllipseSegment);
+
+	if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::ClosedEllipseSegment)
+	{
+		// segment: the ellipse section endpoints connected to the center with two lines
+		arcPath.lineTo(centerX, centerY);
+	}
+	else if (get_ellipse_type() == isobus::OutputEllipse::EllipseType::ClosedEllipseSection)
+	{
+		// section: the ellipse section endpoints connected with a straight line
+		arcPath.closeSubPath();
+	}
+
+	arcOutline.clear();
+	juce::PathStrokeType(lineWidth).createStrokedPath(arcOutline, arcPath);
+}
+
 /**
  * @brief OutputEllipseComponent::addArcToPath
  * Method to draw ellipse segments to keep the angle between the start and end accurate.
  * Juce Path::addArc does not keep the angle when drawing.
+ * Each vertex is where a ray from the centre at that angle crosses the ellipse, found with the polar form
+ * r = ab / sqrt((b cos t)^2 + (a sin t)^2). The number of vertices depends on the radius, so that no straight
+ * piece strays more than MAX_ARC_ERROR pixels from the curve.
  */
-void OutputEllipseComponent::addArcToPath(Path &path, float x, float y, float w, float h, float fromRadians, float toRadians, bool startAsNewSubPath) const
+void OutputEllipseComponent::addArcToPath(Path &path, float x, float y, float w, float h, float fromRadians, float toRadians, bool startAsNewSubPath)
 {
-	float halfWidth = w / 2;
-	float halfHeight = h / 2;
-	bool first = true;
+	const double halfWidth = w / 2.0;
+	const double halfHeight = h / 2.0;
+	const double centerX = x + halfWidth;
+	const double centerY = y + halfHeight;
+
 	if (toRadians < fromRadians)
 	{
 		toRadians += juce::MathConstants<float>().twoPi;
 	}
 
-	for (double drawAngle = fromRadians; drawAngle < toRadians; drawAngle += 0.05)
+	const double sweep = static_cast<double>(toRadians) - static_cast<double>(fromRadians);
+
+	if ((sweep > 0.0) && (halfWidth > 0.0) && (halfHeight > 0.0))
 	{
-		double angle = std::fmod(drawAngle, juce::MathConstants<float>().twoPi);
-		double tanAngle = std::tan(angle);
-		double div = std::sqrt((halfHeight * halfHeight) + (halfWidth * halfWidth) * (tanAngle * tanAngle));
-		double x_ = (halfWidth * halfHeight) / div;
-		double y_ = -(halfWidth * halfHeight * tanAngle) / div;
+		// A chord across an angle of step on a circle of radius r strays r * (1 - cos(step / 2)) from the curve
+		const double radius = std::max(halfWidth, halfHeight);
+		double maxStep = juce::MathConstants<double>().halfPi / 2.0;
 
-		if (std::fabs(angle - juce::MathConstants<float>().halfPi) < 1e-6)
+		if (radius > MAX_ARC_ERROR)
 		{
-			// handle 90°
-			x_ = 0.0;
-			y_ = -halfHeight;
-		}
-		else if (std::fabs(angle - 3 * juce::MathConstants<float>().halfPi) < 1e-6)
-		{
-			// handle 270°
-			x_ = 0.0;
-			y_ = halfHeight;
-		}
-		else if (!(angle < juce::MathConstants<float>().halfPi || angle > 3 * juce::MathConstants<float>().halfPi))
-		{
-			// handle left quadrants 1, 2
-			x_ = -x_;
-			y_ = -y_;
+			maxStep = std::min(maxStep, 2.0 * std::acos(1.0 - (MAX_ARC_ERROR / radius)));
 		}
 
-		x_ += w / 2.0 + x;
-		y_ += h / 2.0 + y;
+		const int segments = std::max(1, static_cast<int>(std::ceil(sweep / maxStep)));
+		const double step = sweep / segments;
+		const double stepCos = std::cos(step);
+		const double stepSin = std::sin(step);
+		double angleCos = std::cos(static_cast<double>(fromRadians));
+		double angleSin = std::sin(static_cast<double>(fromRadians));
 
-		if (first && startAsNewSubPath)
-		{
-			first = false;
-			path.startNewSubPath(x_, y_);
-		}
-		else
+		for (int i = 0; i <= segments; i++)
 		{
-			path.lineTo(x_, y_);
+			const double scaledCos = halfHeight * angleCos;
+			const double scaledSin = halfWidth * angleSin;
+			const double radiusAtAngle = (halfWidth * halfHeight) / std::sqrt((scaledCos * scaledCos) + (scaledSin * scaledSin));
+			const auto pointX = static_cast<float>(centerX + radiusAtAngle * angleCos);
+			const auto pointY = static_cast<float>(centerY - radiusAtAngle * angleSin);
+
+			if ((0 == i) && startAsNewSubPath)
+			{
+				path.startNewSubPath(pointX, pointY);
+			}
+			else
+			{
+				path.lineTo(pointX, pointY);
+			}
+
+			// Rotate to the next angle rather than calling cos and sin for every vertex
+			const double nextCos = (angleCos * stepCos) - (angleSin * stepSin);
+			angleSin = (angleSin * stepCos) + (angleCos * stepSin);
+			angleCos = nextCos;
 		}
 	}
 }
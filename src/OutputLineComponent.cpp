@@ -4,6 +4,8 @@
 ** @copyright  The Open-Agriculture Developers
 *******************************************************************************/
 #include "OutputLineComponent.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 OutputLineComponent::OutputLineComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::OutputLine sourceObject) :
   isobus::OutputLine(sourceObject),
@@ -14,6 +16,8 @@ OutputLineComponent::OutputLineComponent(std::shared_ptr<isobus::VirtualTerminal
 
 void OutputLineComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	if (isobus::NULL_OBJECT_ID != get_line_attributes())
 	{
 		auto child = get_object_by_id(get_line_attributes(), parentWorkingSet->get_object_tree());
@@ -24,8 +28,8 @@ void OutputLineComponent::paint(Graphics &g)
 			{
 				auto line = std::static_pointer_cast<isobus::LineAttributes>(child);
 
-				auto vtColour = parentWorkingSet->get_colour(line->get_background_color());
-				g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+				auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, line->get_background_color());
+				g.setColour(vtColour);
 
 				if (1 == get_height())
 				{
@@ -5,6 +5,7 @@
 *******************************************************************************/
 #include "OutputLinearBarGraphComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 OutputLinearBarGraphComponent::OutputLinearBarGraphComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::OutputLinearBarGraph sourceObject) :
   isobus::OutputLinearBarGraph(sourceObject),
@@ -16,25 +17,23 @@ OutputLinearBarGraphComponent::OutputLinearBarGraphComponent(std::shared_ptr<iso
 
 void OutputLinearBarGraphComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	float valueRatioToMax = static_cast<float>(get_value()) / static_cast<float>(get_max_value());
 	float targetRatioToMax = static_cast<float>(get_target_value()) / static_cast<float>(get_max_value());
-	auto vtBackgroundColour = parentWorkingSet->get_colour(get_colour());
-	auto vtTargetLineColour = parentWorkingSet->get_colour(get_target_line_colour());
-	g.setColour(Colour::fromFloatRGBA(vtBackgroundColour.r, vtBackgroundColour.g, vtBackgroundColour.b, 1.0));
+	auto vtBackgroundColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_colour());
+	auto vtTargetLineColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_target_line_colour());
+	g.setColour(vtBackgroundColour);
 
 	if (get_option(Options::DrawBorder))
 	{
 		g.drawRect(0, 0, getWidth(), getHeight(), 3);
 	}
 
-	if (isobus::NULL_OBJECT_ID != get_variable_reference())
+	auto variable = numberVariable.get(parentWorkingSet, get_variable_reference(), isobus::VirtualTerminalObjectType::NumberVariable);
+	if (nullptr != variable)
 	{
-		auto child = get_object_by_id(get_variable_reference(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::NumberVariable == child->get_object_type()))
-		{
-			valueRatioToMax = static_cast<float>(std::static_pointer_cast<isobus::NumberVariable>(child)->get_value()) / static_cast<float>(get_max_value());
-		}
+		valueRatioToMax = static_cast<float>(variable->get_value()) / static_cast<float>(get_max_value());
 	}
 
 	// Figure out what kind of bar graph we are
@@ -52,7 +51,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawVerticalLine(static_cast<float>(get_width()) * targetRatioToMax, 0.0f, static_cast<float>(get_height()));
 				}
 			}
@@ -63,7 +62,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawVerticalLine(static_cast<float>(get_width()) * (1.0f - targetRatioToMax), 0.0f, static_cast<float>(get_height()));
 				}
 			}
@@ -78,7 +77,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawHorizontalLine(static_cast<float>(get_height() * (1.0f - targetRatioToMax)), 0.0f, static_cast<float>(get_width()));
 				}
 			}
@@ -89,7 +88,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawHorizontalLine(static_cast<float>(get_height() * targetRatioToMax), 0.0f, static_cast<float>(get_width()));
 				}
 			}
@@ -109,7 +108,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawVerticalLine(static_cast<float>(get_width()) * targetRatioToMax, 0.0f, static_cast<float>(get_height()));
 				}
 			}
@@ -120,7 +119,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawVerticalLine(static_cast<float>(get_width()) * (1 - targetRatioToMax), 0.0f, static_cast<float>(get_height()));
 				}
 			}
@@ -135,7 +134,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawHorizontalLine(static_cast<float>(get_height() * (1 - targetRatioToMax)), 0.0f, static_cast<float>(get_width()));
 				}
 			}
@@ -146,7 +145,7 @@ void OutputLinearBarGraphComponent::paint(Graphics &g)
 
 				if (get_option(Options::DrawTargetLine))
 				{
-					g.setColour(Colour::fromFloatRGBA(vtTargetLineColour.r, vtTargetLineColour.g, vtTargetLineColour.b, 1.0));
+					g.setColour(vtTargetLineColour);
 					g.drawHorizontalLine(static_cast<float>(get_height() * targetRatioToMax), 0.0f, static_cast<float>(get_width()));
 				}
 			}
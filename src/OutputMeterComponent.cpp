@@ -4,6 +4,8 @@
 ** @copyright  The Open-Agriculture Developers
 *******************************************************************************/
 #include "OutputMeterComponent.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 #include <cmath>
 
@@ -17,96 +19,150 @@ OutputMeterComponent::OutputMeterComponent(std::shared_ptr<isobus::VirtualTermin
 
 void OutputMeterComponent::paint(Graphics &g)
 {
-	if (get_option(Options::DrawBorder))
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
+	DialKey currentKey;
+	currentKey.width = get_width();
+	currentKey.height = get_height();
+	currentKey.startAngle = get_start_angle();
+	currentKey.endAngle = get_end_angle();
+	currentKey.numberOfTicks = get_number_of_ticks();
+	currentKey.drawArc = get_option(Options::DrawArc);
+	currentKey.drawBorder = get_option(Options::DrawBorder);
+	currentKey.drawTicks = get_option(Options::DrawTicks);
+	currentKey.borderColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_border_colour());
+	currentKey.arcAndTickColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_arc_and_tick_colour());
+	currentKey.scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+	// The dial only changes when the meter's attributes do, so value changes just redraw the needle over it
+	if (dialImage.isNull() || (!(currentKey == dialKey)))
 	{
-		auto vtColour = parentWorkingSet->get_colour(get_border_colour());
-		g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
-		g.drawRect(0, 0, static_cast<int>(get_width()), static_cast<int>(get_height()), 1);
+		dialKey = currentKey;
+		render_dial();
 	}
-	if (get_option(Options::DrawArc))
-	{
-		Path p;
-		PathStrokeType pathStroke(1.0f, PathStrokeType::JointStyle::curved);
-
-		float startVtAngle = get_start_angle() * 2.0f * 0.0174533f;
-		float endVtAngle = get_end_angle() * 2.0f * 0.0174533f;
-		float ellipseRotation = 3.14159f / 2.0f;
-
-		if (endVtAngle < startVtAngle)
-		{
-			endVtAngle += (2.0f * 3.14159f);
-		}
 
-		if (startVtAngle < endVtAngle)
-		{
-			ellipseRotation = -ellipseRotation;
-		}
-
-		p.addCentredArc(static_cast<float>(get_width()) / 2.0f, static_cast<float>(get_height()) / 2.0f, static_cast<float>(get_width()) / 2.0f, static_cast<float>(get_height()) / 2.0f, ellipseRotation, startVtAngle, endVtAngle, true);
-		g.setColour(Colours::black);
-		g.strokePath(p, pathStroke);
+	if (dialImage.isValid())
+	{
+		g.drawImageTransformed(dialImage, AffineTransform::scale(1.0f / dialKey.scale));
 	}
 
 	std::uint32_t needleValue = get_value();
-	if (isobus::NULL_OBJECT_ID != get_variable_reference())
+	auto variable = numberVariable.get(parentWorkingSet, get_variable_reference(), isobus::VirtualTerminalObjectType::NumberVariable);
+	if (nullptr != variable)
 	{
-		auto varNum = get_object_by_id(get_variable_reference(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != varNum) && (isobus::VirtualTerminalObjectType::NumberVariable == varNum->get_object_type()))
-		{
-			needleValue = std::static_pointer_cast<isobus::NumberVariable>(varNum)->get_value();
-		}
+		needleValue = variable->get_value();
 	}
-	auto vtColour = parentWorkingSet->get_colour(get_needle_colour());
-	Path needlePath;
-	float endVtAngleDeg = get_end_angle() * 2.0f;
-	float startVtAngleDeg = get_start_angle() * 2.0f;
 
-	if (endVtAngleDeg < startVtAngleDeg)
+	float deflection = 0.0f;
+	if (get_max_value() > get_min_value())
 	{
-		endVtAngleDeg += (360);
+		deflection = (static_cast<float>(needleValue) - static_cast<float>(get_min_value())) / static_cast<float>(get_max_value() - get_min_value());
+		deflection = jlimit(0.0f, 1.0f, deflection);
 	}
 
-	float theta = (static_cast<float>(needleValue) / get_max_value()) * (startVtAngleDeg - endVtAngleDeg);
-	float needleEndAngle = 0.0f;
+	float startDegrees = 0.0f;
+	float sweepDegrees = 0.0f;
+	float needleDegrees = 0.0f;
+	get_range_angles(startDegrees, sweepDegrees);
 
 	if (true == get_option(Options::DeflectionDirection))
 	{
-		// clockwise
-		needleEndAngle = (endVtAngleDeg + theta);
+		// clockwise, from the end angle back towards the start angle
+		needleDegrees = startDegrees + sweepDegrees - (deflection * sweepDegrees);
 	}
 	else
 	{
-		// counter clockwise
-		needleEndAngle = (endVtAngleDeg - theta);
+		// counter clockwise, from the start angle towards the end angle
+		needleDegrees = startDegrees + (deflection * sweepDegrees);
+	}
+
+	g.setColour(JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_needle_colour()));
+	g.drawLine(Line<float>(get_point_on_dial(needleDegrees, 0.0f), get_point_on_dial(needleDegrees, 1.0f)), NEEDLE_THICKNESS);
+}
+
+bool OutputMeterComponent::DialKey::operator==(const DialKey &other) const
+{
+	return ((width == other.width) &&
+	        (height == other.height) &&
+	        (startAngle == other.startAngle) &&
+	        (endAngle == other.endAngle) &&
+	        (numberOfTicks == other.numberOfTicks) &&
+	        (drawArc == other.drawArc) &&
+	        (drawBorder == other.drawBorder) &&
+	        (drawTicks == other.drawTicks) &&
+	        (borderColour == other.borderColour) &&
+	        (arcAndTickColour == other.arcAndTickColour) &&
+	        (scale == other.scale));
+}
+
+void OutputMeterComponent::get_range_angles(float &startDegrees, float &sweepDegrees) const
+{
+	float endDegrees = get_end_angle() * 2.0f;
+	startDegrees = get_start_angle() * 2.0f;
+
+	if (endDegrees < startDegrees)
+	{
+		endDegrees += 360.0f;
 	}
+	sweepDegrees = endDegrees - startDegrees;
+}
+
+Point<float> OutputMeterComponent::get_point_on_dial(float degrees, float radiusFraction) const
+{
+	// VT angles start at the positive X axis and go counter clockwise, but screen Y points down
+	const float radians = degreesToRadians(degrees);
+	const float centreX = get_width() / 2.0f;
+	const float centreY = get_height() / 2.0f;
+
+	return { centreX + (centreX * radiusFraction * std::cos(radians)), centreY - (centreY * radiusFraction * std::sin(radians)) };
+}
+
+void OutputMeterComponent::render_dial()
+{
+	const int imageWidth = roundToInt(dialKey.width * dialKey.scale);
+	const int imageHeight = roundToInt(dialKey.height * dialKey.scale);
+
+	if ((imageWidth > 0) && (imageHeight > 0))
+	{
+		dialImage = Image(Image::ARGB, imageWidth, imageHeight, true);
+		Graphics g(dialImage);
+		g.addTransform(AffineTransform::scale(dialKey.scale));
 
-	float xOffset = (get_width() / 2.0f) * std::cos(needleEndAngle * 3.14159265f / 180.0f);
-	float yOffset = -(get_width() / 2.0f) * std::sin(needleEndAngle * 3.14159265f / 180.0f);
+		if (dialKey.drawBorder)
+		{
+			g.setColour(dialKey.borderColour);
+			g.drawRect(0, 0, static_cast<int>(dialKey.width), static_cast<int>(dialKey.height), 1);
+		}
 
-	g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
-	g.drawLine((get_width() / 2.0f) + xOffset, (get_width() / 2.0f) + yOffset, get_width() / 2.0f, get_height() / 2.0f, 3.0f);
+		float startDegrees = 0.0f;
+		float sweepDegrees = 0.0f;
+		get_range_angles(startDegrees, sweepDegrees);
+		g.setColour(dialKey.arcAndTickColour);
+
+		if (dialKey.drawArc)
+		{
+			// JUCE arcs start at 12 o'clock and go clockwise, so convert from VT angles
+			const float centreX = dialKey.width / 2.0f;
+			const float centreY = dialKey.height / 2.0f;
+			Path arc;
+			arc.addCentredArc(centreX, centreY, centreX - 0.5f, centreY - 0.5f, 0.0f, degreesToRadians(90.0f - startDegrees), degreesToRadians(90.0f - startDegrees - sweepDegrees), true);
+			g.strokePath(arc, PathStrokeType(1.0f, PathStrokeType::JointStyle::curved));
+		}
 
-	g.setColour(Colours::black);
-	if ((get_option(Options::DrawTicks)) && (get_number_of_ticks() > 0))
+		if (dialKey.drawTicks && (dialKey.numberOfTicks > 0))
+		{
+			// Spread the ticks so the first and last land on the ends of the range
+			const float degreesPerTick = (dialKey.numberOfTicks > 1) ? (sweepDegrees / static_cast<float>(dialKey.numberOfTicks - 1)) : 0.0f;
+
+			for (std::uint8_t i = 0; i < dialKey.numberOfTicks; i++)
+			{
+				const float tickDegrees = startDegrees + (degreesPerTick * i);
+				g.drawLine(Line<float>(get_point_on_dial(tickDegrees, 1.0f - TICK_LENGTH), get_point_on_dial(tickDegrees, 1.0f)), TICK_THICKNESS);
+			}
+		}
+	}
+	else
 	{
-		//float degreesPerTick = ((get_start_angle() * 2.0f) - (get_end_angle() * 2.0f)) / static_cast<float>(get_number_of_ticks());
-
-		//for (std::uint8_t i = 0; i < get_number_of_ticks(); i++)
-		//{
-		//	if (true == get_option(Options::DeflectionDirection))
-		//	{
-		//		// clockwise
-		//		needleEndAngle = (get_end_angle() * 2.0f) + (degreesPerTick * i);
-		//	}
-		//	else
-		//	{
-		//		// counter clockwise
-		//		needleEndAngle = (get_end_angle() * 2.0f) - (degreesPerTick * i);
-		//	}
-		//	xCoord = (get_width() / 2.0f) * std::cos(needleEndAngle * 3.14159265f / 180.0f);
-		//	yCoord = (get_width() / 2.0f) * std::sin(needleEndAngle * 3.14159265f / 180.0f);
-		//	g.drawLine((get_width() / 2) + xCoord, (get_height() / 2) + yCoord, (get_width() / 2) * 0.9f + xCoord, (get_height() / 2) *0.9f + yCoord, 3.0f);
-		//}
+		dialImage = Image();
 	}
 }
@@ -5,6 +5,9 @@
 *******************************************************************************/
 #include "OutputNumberComponent.hpp"
 
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
+
 #include <iomanip>
 #include <sstream>
 
@@ -26,42 +29,31 @@ OutputNumberComponent::OutputNumberComponent(std::shared_ptr<isobus::VirtualTerm
 
 void OutputNumberComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	if (isOpaque())
 	{
-		auto vtColour = parentWorkingSet->get_colour(backgroundColor);
-		g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+		auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, backgroundColor);
+		g.fillAll(vtColour);
 	}
 
 	double scaledValue = (static_cast<double>(get_value()) + static_cast<double>(get_offset())) * static_cast<double>(get_scale());
 	g.setColour(getLookAndFeel().findColour(ListBox::textColourId));
 
 	// Get font data
-	if (isobus::NULL_OBJECT_ID != get_font_attributes())
-	{
-		auto child = get_object_by_id(get_font_attributes(), parentWorkingSet->get_object_tree());
+	auto font = JuceManagedWorkingSetCache::get_font(parentWorkingSet, get_font_attributes());
 
-		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::FontAttributes == child->get_object_type()))
-		{
-			auto font = std::static_pointer_cast<isobus::FontAttributes>(child);
-
-			auto colour = parentWorkingSet->get_colour(font->get_colour());
-			Font juceFont(Font::getDefaultMonospacedFontName(), font->get_font_height_pixels(), Font::FontStyleFlags::plain);
-			auto fontWidth = juceFont.getStringWidthFloat("1");
-			juceFont.setHorizontalScale(static_cast<float>(font->get_font_width_pixels()) / fontWidth);
-			g.setColour(Colour::fromFloatRGBA(colour.r, colour.g, colour.b, 1.0f));
-			g.setFont(juceFont);
-		}
+	if (nullptr != font)
+	{
+		g.setColour(font->colour);
+		g.setFont(font->plainFont);
 	}
 
-	if (isobus::NULL_OBJECT_ID != get_variable_reference())
+	auto variable = numberVariable.get(parentWorkingSet, get_variable_reference(), isobus::VirtualTerminalObjectType::NumberVariable);
+	if (nullptr != variable)
 	{
-		auto child = get_object_by_id(get_variable_reference(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::NumberVariable == child->get_object_type()))
-		{
-			std::int64_t offsetValue = static_cast<std::int64_t>(std::static_pointer_cast<isobus::NumberVariable>(child)->get_value()) + get_offset();
-			scaledValue = static_cast<double>(offsetValue) * static_cast<double>(get_scale());
-		}
+		std::int64_t offsetValue = static_cast<std::int64_t>(variable->get_value()) + get_offset();
+		scaledValue = static_cast<double>(offsetValue) * static_cast<double>(get_scale());
 	}
 
 	if (get_option(isobus::OutputNumber::Options::DisplayZeroAsBlank) && scaledValue == 0.0f)
@@ -4,6 +4,8 @@
 ** @copyright  The Open-Agriculture Developers
 *******************************************************************************/
 #include "OutputPolygonComponent.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 OutputPolygonComponent::OutputPolygonComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::OutputPolygon sourceObject) :
   isobus::OutputPolygon(sourceObject),
@@ -14,6 +16,8 @@ OutputPolygonComponent::OutputPolygonComponent(std::shared_ptr<isobus::VirtualTe
 
 void OutputPolygonComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	// 3 Points MUST exist or the object cannot be drawn
 	if (get_number_of_points() >= 3)
 	{
@@ -29,9 +33,8 @@ void OutputPolygonComponent::paint(Graphics &g)
 			{
 				auto line = std::static_pointer_cast<isobus::LineAttributes>(child);
 				lineWidth = line->get_width();
-				auto lineAttributeColour = parentWorkingSet->get_colour(line->get_background_color());
 
-				lineColour = Colour::fromFloatRGBA(lineAttributeColour.r, lineAttributeColour.g, lineAttributeColour.b, 1.0);
+				lineColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, line->get_background_color());
 			}
 		}
 
@@ -70,8 +73,7 @@ void OutputPolygonComponent::paint(Graphics &g)
 				}
 				else if (fill->get_type() == isobus::FillAttributes::FillType::FillWithSpecifiedColorInFillColorAttribute)
 				{
-					auto vtColour = parentWorkingSet->get_colour(fill->get_background_color());
-					g.setFillType(FillType(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f)));
+					g.setFillType(FillType(JuceManagedWorkingSetCache::get_colour(parentWorkingSet, fill->get_background_color())));
 				}
 				else
 				{
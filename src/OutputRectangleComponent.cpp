@@ -4,109 +4,125 @@
 ** @copyright  The Open-Agriculture Developers
 *******************************************************************************/
 #include "OutputRectangleComponent.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 OutputRectangleComponent::OutputRectangleComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::OutputRectangle sourceObject) :
   isobus::OutputRectangle(sourceObject),
   parentWorkingSet(workingSet)
 {
 	setSize(get_width(), get_height());
+	update_opacity();
 }
 
-void OutputRectangleComponent::paint(Graphics &g)
+void OutputRectangleComponent::update_opacity()
 {
-	auto vtColour = parentWorkingSet->get_colour(backgroundColor);
 	bool isOpaque = false;
+	auto fill = fillAttributes.get(parentWorkingSet, get_fill_attributes(), isobus::VirtualTerminalObjectType::FillAttributes);
 
-	if (isobus::NULL_OBJECT_ID != get_fill_attributes())
+	if (nullptr != fill)
 	{
-		auto child = get_object_by_id(get_fill_attributes(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::FillAttributes == child->get_object_type()))
+		switch (fill->get_type())
 		{
-			auto fill = std::static_pointer_cast<isobus::FillAttributes>(child);
+			case isobus::FillAttributes::FillType::FillWithLineColor:
+			{
+				isOpaque = (nullptr != lineAttributes.get(parentWorkingSet, get_line_attributes(), isobus::VirtualTerminalObjectType::LineAttributes));
+			}
+			break;
 
-			vtColour = parentWorkingSet->get_colour(fill->get_background_color());
-			switch (std::static_pointer_cast<isobus::FillAttributes>(child)->get_type())
+			case isobus::FillAttributes::FillType::FillWithSpecifiedColorInFillColorAttribute:
 			{
-				case isobus::FillAttributes::FillType::FillWithPatternGivenByFillPatternAttribute:
-				{
-					// @todo
-					isOpaque = true;
-				}
-				break;
+				isOpaque = true;
+			}
+			break;
 
-				case isobus::FillAttributes::FillType::FillWithLineColor:
-				{
-					auto childLineAttributes = get_object_by_id(get_line_attributes(), parentWorkingSet->get_object_tree());
+			case isobus::FillAttributes::FillType::FillWithPatternGivenByFillPatternAttribute: // @todo Patterns aren't drawn yet
+			case isobus::FillAttributes::FillType::NoFill:
+			default:
+			{
+				isOpaque = false;
+			}
+			break;
+		}
+	}
+	setOpaque(isOpaque);
+}
 
-					if ((nullptr != childLineAttributes) && (isobus::VirtualTerminalObjectType::LineAttributes == childLineAttributes->get_object_type()))
-					{
-						auto line = std::static_pointer_cast<isobus::LineAttributes>(childLineAttributes);
-						vtColour = parentWorkingSet->get_colour(line->get_background_color());
-						g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0));
-						g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
-						break;
-					}
-					isOpaque = true;
-				}
-				break;
+void OutputRectangleComponent::paint(Graphics &g)
+{
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
 
-				case isobus::FillAttributes::FillType::FillWithSpecifiedColorInFillColorAttribute:
-				{
-					g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
-					isOpaque = true;
-				}
-				break;
+	auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, backgroundColor);
+
+	auto fill = fillAttributes.get(parentWorkingSet, get_fill_attributes(), isobus::VirtualTerminalObjectType::FillAttributes);
+	auto line = lineAttributes.get(parentWorkingSet, get_line_attributes(), isobus::VirtualTerminalObjectType::LineAttributes);
+
+	if (nullptr != fill)
+	{
+		vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, fill->get_background_color());
+		switch (fill->get_type())
+		{
+			case isobus::FillAttributes::FillType::FillWithPatternGivenByFillPatternAttribute:
+			{
+				// @todo
+			}
+			break;
 
-				case isobus::FillAttributes::FillType::NoFill:
-				default:
+			case isobus::FillAttributes::FillType::FillWithLineColor:
+			{
+				if (nullptr != line)
 				{
-					// No fill
-					isOpaque = false;
+					vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, line->get_background_color());
+					g.setColour(vtColour);
+					g.fillAll(vtColour);
 				}
-				break;
 			}
+			break;
+
+			case isobus::FillAttributes::FillType::FillWithSpecifiedColorInFillColorAttribute:
+			{
+				g.fillAll(vtColour);
+			}
+			break;
+
+			case isobus::FillAttributes::FillType::NoFill:
+			default:
+			{
+				// No fill
+			}
+			break;
 		}
 	}
 
-	setOpaque(isOpaque);
-
-	if (isobus::NULL_OBJECT_ID != get_line_attributes())
+	if (nullptr != line)
 	{
-		auto child = get_object_by_id(get_line_attributes(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) && (isobus::VirtualTerminalObjectType::LineAttributes == child->get_object_type()))
+		if (0 != line->get_width())
 		{
-			auto line = std::static_pointer_cast<isobus::LineAttributes>(child);
+			bool anyLineSuppressed = (0 != get_line_suppression_bitfield());
+			vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, line->get_background_color());
+			g.setColour(vtColour);
 
-			if (0 != line->get_width())
+			if (!anyLineSuppressed)
 			{
-				bool anyLineSuppressed = (0 != get_line_suppression_bitfield());
-				vtColour = parentWorkingSet->get_colour(line->get_background_color());
-				g.setColour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0));
-
-				if (!anyLineSuppressed)
+				g.drawRect(0, 0, static_cast<int>(get_width()), static_cast<int>(get_height()), line->get_width());
+			}
+			else // Something is suppressed
+			{
+				if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressTopLine)) & get_line_suppression_bitfield()))
+				{
+					g.drawLine(0, 0, get_width(), 0, line->get_width());
+				}
+				if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressLeftSideLine)) & get_line_suppression_bitfield()))
+				{
+					g.drawLine(0, 0, 0, get_height(), line->get_width());
+				}
+				if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressRightSideLine)) & get_line_suppression_bitfield()))
 				{
-					g.drawRect(0, 0, static_cast<int>(get_width()), static_cast<int>(get_height()), line->get_width());
+					g.drawLine(get_width(), 0, get_width(), get_height(), line->get_width());
 				}
-				else // Something is suppressed
+				if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressBottomLine)) & get_line_suppression_bitfield()))
 				{
-					if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressTopLine)) & get_line_suppression_bitfield()))
-					{
-						g.drawLine(0, 0, get_width(), 0, line->get_width());
-					}
-					if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressLeftSideLine)) & get_line_suppression_bitfield()))
-					{
-						g.drawLine(0, 0, 0, get_height(), line->get_width());
-					}
-					if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressRightSideLine)) & get_line_suppression_bitfield()))
-					{
-						g.drawLine(get_width(), 0, get_width(), get_height(), line->get_width());
-					}
-					if (0 == ((0x01 << static_cast<std::uint8_t>(LineSuppressionOption::SuppressBottomLine)) & get_line_suppression_bitfield()))
-					{
-						g.drawLine(0, get_height(), get_width(), get_height(), line->get_width());
-					}
+					g.drawLine(0, get_height(), get_width(), get_height(), line->get_width());
 				}
 			}
 		}
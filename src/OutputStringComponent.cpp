@@ -5,6 +5,9 @@
 *******************************************************************************/
 #include "OutputStringComponent.hpp"
 
+#include "FlashScheduler.hpp"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 #include "StringEncodingConversions.hpp"
 
 OutputStringComponent::OutputStringComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::OutputString sourceObject) :
@@ -12,11 +15,18 @@ OutputStringComponent::OutputStringComponent(std::shared_ptr<isobus::VirtualTerm
   parentWorkingSet(workingSet)
 {
 	setSize(get_width(), get_height());
-	setOpaque(false);
+	update_opacity();
+}
+
+OutputStringComponent::~OutputStringComponent()
+{
+	FlashScheduler::unsubscribe(this);
 }
 
 void OutputStringComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
 	std::string value = displayed_value(parentWorkingSet);
 
 	std::size_t pos = value.find('\0');
@@ -25,65 +35,75 @@ void OutputStringComponent::paint(Graphics &g)
 		value = value.substr(0, pos);
 	}
 
-	std::uint8_t fontHeight = 0;
-	auto fontType = isobus::FontAttributes::FontType::ISO8859_1;
-
-	auto vtColour = parentWorkingSet->get_colour(get_background_color());
-	juce::Colour backgroundColor = Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f);
+	juce::Colour backgroundColor = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_background_color());
 	juce::Colour drawColor = getLookAndFeel().findColour(ListBox::textColourId);
 
 	// Get font data
 	auto fontAttrID = get_font_attributes();
+	auto font = JuceManagedWorkingSetCache::get_font(parentWorkingSet, fontAttrID);
 
-	if (isobus::NULL_OBJECT_ID != fontAttrID)
+	if (nullptr != font)
 	{
-		auto child = get_object_by_id(fontAttrID, parentWorkingSet->get_object_tree());
+		const bool show = FlashScheduler::is_shown();
 
-		if (isobus::VirtualTerminalObjectType::FontAttributes == child->get_object_type())
+		if (font->flashingHidden && !show && !font->flashing) // Bit 6 (Flashing) has priority over bit 5 (FlashingHidden)
 		{
-			auto font = std::static_pointer_cast<isobus::FontAttributes>(child);
+			return;
+		}
 
-			if (font->get_style(isobus::FontAttributes::FontStyleBits::FlashingHidden) && !show && !font->get_style(isobus::FontAttributes::FontStyleBits::Flashing)) // Bit 6 (Flashing) has priority over bit 5 (FlashingHidden)
-			{
-				return;
-			}
+		drawColor = font->colour;
 
-			fontType = font->get_type();
-			auto colour = parentWorkingSet->get_colour(font->get_colour());
-			Font juceFont;
-			int fontStyleFlags = Font::FontStyleFlags::plain;
+		// swap background and draw colors for inverted draw style
+		if (font->inverted || (font->flashing && !show))
+		{
+			auto tmpColor = backgroundColor;
+			backgroundColor = drawColor;
+			drawColor = tmpColor;
+		}
+	}
 
-			if (font->get_style(isobus::FontAttributes::FontStyleBits::Bold))
-			{
-				fontStyleFlags |= Font::FontStyleFlags::bold;
-			}
+	LayoutKey currentKey;
+	currentKey.rawValue = value;
+	currentKey.objectRevision = JuceManagedWorkingSetCache::get_object_revision(parentWorkingSet, get_id());
+	currentKey.fontRevision = JuceManagedWorkingSetCache::get_object_revision(parentWorkingSet, fontAttrID);
+	currentKey.width = get_width();
+	currentKey.height = get_height();
 
-			if (font->get_style(isobus::FontAttributes::FontStyleBits::Italic))
-			{
-				fontStyleFlags |= Font::FontStyleFlags::italic;
-			}
+	if ((!layoutValid) || (!(currentKey == layoutKey)))
+	{
+		update_layout(std::move(value), font, g.getCurrentFont());
+		layoutKey = std::move(currentKey);
+		layoutValid = true;
+	}
 
-			if (font->get_style(isobus::FontAttributes::FontStyleBits::Underlined))
-			{
-				fontStyleFlags |= Font::FontStyleFlags::underlined;
-			}
+	if (!get_option(Options::Transparent))
+	{
+		g.fillAll(backgroundColor);
+	}
+	g.setColour(drawColor);
+	layout.draw(g);
+}
 
-			juceFont = Font(Font::getDefaultMonospacedFontName(), font->get_font_height_pixels(), fontStyleFlags);
+bool OutputStringComponent::LayoutKey::operator==(const LayoutKey &other) const
+{
+	return ((objectRevision == other.objectRevision) &&
+	        (fontRevision == other.fontRevision) &&
+	        (width == other.width) &&
+	        (height == other.height) &&
+	        (rawValue == other.rawValue));
+}
 
-			auto fontWidth = juceFont.getStringWidthFloat("a");
-			fontHeight = font->get_font_width_pixels();
-			juceFont.setHorizontalScale(static_cast<float>(font->get_font_width_pixels()) / fontWidth);
-			drawColor = Colour::fromFloatRGBA(colour.r, colour.g, colour.b, 1.0f);
-			g.setFont(juceFont);
+void OutputStringComponent::update_layout(std::string value, std::shared_ptr<const JuceManagedWorkingSetCache::ResolvedFont> font, const Font &defaultFont)
+{
+	std::uint8_t fontHeight = 0;
+	auto fontType = isobus::FontAttributes::FontType::ISO8859_1;
+	Font juceFont = defaultFont;
 
-			// swap background and draw colors for inverted draw style
-			if (font->get_style(isobus::FontAttributes::FontStyleBits::Inverted) || (font->get_style(isobus::FontAttributes::FontStyleBits::Flashing) && !show))
-			{
-				auto tmpColor = backgroundColor;
-				backgroundColor = drawColor;
-				drawColor = tmpColor;
-			}
-		}
+	if (nullptr != font)
+	{
+		fontType = font->type;
+		fontHeight = font->widthPixels;
+		juceFont = font->font;
 	}
 
 	if (0 == fontHeight)
@@ -91,7 +111,7 @@ void OutputStringComponent::paint(Graphics &g)
 		fontHeight = 8;
 	}
 
-	String decodedValue(value);
+	decodedValue = String(value);
 
 	if ((value.length() >= 2) &&
 	    (0xFF == static_cast<std::uint8_t>(value.at(0))) &&
@@ -159,19 +179,12 @@ void OutputStringComponent::paint(Graphics &g)
 		}
 	}
 
-	if (!get_option(Options::Transparent))
-	{
-		g.fillAll(backgroundColor);
-	}
-	g.setColour(drawColor);
+	// This is the same layout Graphics::drawFittedText does, kept so that painting an unchanged string only has to replay the glyphs
+	layout.clear();
 
-	if (get_option(Options::AutoWrap)) // TODO need to figure out proper font clipping
-	{
-		g.drawFittedText(decodedValue, 0, 0, get_width(), get_height(), convert_justification(get_horizontal_justification(), get_vertical_justification()), static_cast<int>(std::floor((static_cast<float>(get_height()) + 0.1f) / fontHeight)), 0.8f);
-	}
-	else
+	if (decodedValue.isNotEmpty() && (get_width() > 0) && (get_height() > 0))
 	{
-		g.drawFittedText(decodedValue, 0, 0, get_width(), get_height(), convert_justification(get_horizontal_justification(), get_vertical_justification()), static_cast<int>(std::floor((static_cast<float>(get_height()) + 0.1f) / fontHeight)), 0.8f);
+		layout.addFittedText(juceFont, decodedValue, 0.0f, 0.0f, static_cast<float>(get_width()), static_cast<float>(get_height()), convert_justification(get_horizontal_justification(), get_vertical_justification()), static_cast<int>(std::floor((static_cast<float>(get_height()) + 0.1f) / fontHeight)), 0.8f);
 	}
 }
 
@@ -284,33 +297,25 @@ void OutputStringComponent::visibilityChanged()
 
 		if (visible && isFlashing())
 		{
-			startTimer(500);
+			FlashScheduler::subscribe(this);
 		}
 		else
 		{
-			stopTimer();
+			FlashScheduler::unsubscribe(this);
 		}
 	}
 }
 
-void OutputStringComponent::timerCallback()
+void OutputStringComponent::update_opacity()
 {
-	show = !show;
-	repaint();
+	auto font = JuceManagedWorkingSetCache::get_font(parentWorkingSet, get_font_attributes());
+	const bool hiddenWhileFlashing = (nullptr != font) && font->flashingHidden && (!font->flashing);
+
+	setOpaque((!get_option(Options::Transparent)) && (!hiddenWhileFlashing));
 }
 
 bool OutputStringComponent::isFlashing() const
 {
-	auto fontAttrID = get_font_attributes();
-	if (isobus::NULL_OBJECT_ID != fontAttrID)
-	{
-		auto child = get_object_by_id(fontAttrID, parentWorkingSet->get_object_tree());
-
-		if (nullptr != child && isobus::VirtualTerminalObjectType::FontAttributes == child->get_object_type())
-		{
-			auto font = std::static_pointer_cast<isobus::FontAttributes>(child);
-			return font->get_style(isobus::FontAttributes::FontStyleBits::Flashing) || font->get_style(isobus::FontAttributes::FontStyleBits::FlashingHidden);
-		}
-	}
-	return false;
+	auto font = JuceManagedWorkingSetCache::get_font(parentWorkingSet, get_font_attributes());
+	return (nullptr != font) && (font->flashing || font->flashingHidden);
 }
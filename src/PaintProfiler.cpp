@@ -0,0 +1,303 @@
+/*******************************************************************************
+** @file       PaintProfiler.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "PaintProfiler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+std::map<isobus::VirtualTerminalObjectType, PaintProfiler::Histogram> PaintProfiler::objectTypePaints;
+std::map<std::uint64_t, PaintProfiler::Histogram> PaintProfiler::workingSetPaints;
+PaintProfiler::Histogram PaintProfiler::frames;
+std::uint32_t PaintProfiler::currentFrame_us = 0;
+bool PaintProfiler::currentFrameHasPaints = false;
+
+void PaintProfiler::Histogram::add(std::uint32_t duration_us)
+{
+	std::size_t bucket = 0;
+
+	while (((bucket + 1) < NUMBER_OF_BUCKETS) && (duration_us >= (2u << bucket)))
+	{
+		bucket++;
+	}
+	buckets.at(bucket)++;
+	total_us += duration_us;
+	count++;
+	max_us = std::max(max_us, duration_us);
+}
+
+std::uint32_t PaintProfiler::Histogram::get_percentile(std::uint32_t percentile) const
+{
+	std::uint32_t retVal = 0;
+	const std::uint64_t target = ((static_cast<std::uint64_t>(count) * std::min<std::uint32_t>(percentile, 100)) + 99) / 100;
+	std::uint64_t seen = 0;
+
+	for (std::size_t i = 0; (i < NUMBER_OF_BUCKETS) && (0 != count); i++)
+	{
+		seen += buckets.at(i);
+
+		if (seen >= target)
+		{
+			// The last bucket has no upper edge, so use the longest duration instead
+			retVal = ((i + 1) < NUMBER_OF_BUCKETS) ? std::min(max_us, (2u << i)) : max_us;
+			break;
+		}
+	}
+	return retVal;
+}
+
+PaintProfiler::ScopedPaintTimer::ScopedPaintTimer(isobus::VirtualTerminalObjectType type, const std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> &owner) :
+  startTime(std::chrono::steady_clock::now()),
+  workingSet(owner.get()),
+  objectType(type)
+{
+}
+
+PaintProfiler::ScopedPaintTimer::~ScopedPaintTimer()
+{
+	auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+	record_paint(objectType, workingSet, static_cast<std::uint32_t>(std::min<std::chrono::microseconds::rep>(duration.count(), static_cast<std::chrono::microseconds::rep>(std::numeric_limits<std::uint32_t>::max()))));
+}
+
+void PaintProfiler::end_frame()
+{
+	if (currentFrameHasPaints)
+	{
+		frames.add(currentFrame_us);
+		currentFrame_us = 0;
+		currentFrameHasPaints = false;
+	}
+}
+
+void PaintProfiler::reset()
+{
+	objectTypePaints.clear();
+	workingSetPaints.clear();
+	frames = Histogram();
+	currentFrame_us = 0;
+	currentFrameHasPaints = false;
+}
+
+String PaintProfiler::get_summary(std::size_t maximumRows)
+{
+	std::vector<std::pair<isobus::VirtualTerminalObjectType, const Histogram *>> slowest;
+	String retVal;
+
+	for (const auto &objectType : objectTypePaints)
+	{
+		slowest.emplace_back(objectType.first, &objectType.second);
+	}
+	std::sort(slowest.begin(), slowest.end(), [](const auto &first, const auto &second) { return first.second->total_us > second.second->total_us; });
+
+	retVal << "Frames: " << static_cast<int>(frames.count)
+	       << "  p50 " << static_cast<int>(frames.get_percentile(50)) << " us"
+	       << "  p95 " << static_cast<int>(frames.get_percentile(95)) << " us"
+	       << "  max " << static_cast<int>(frames.max_us) << " us\n";
+
+	for (std::size_t i = 0; (i < slowest.size()) && (i < maximumRows); i++)
+	{
+		const auto &histogram = *slowest.at(i).second;
+		retVal << get_object_type_name(slowest.at(i).first) << ": "
+		       << static_cast<int>(histogram.count) << " paints, "
+		       << static_cast<int>(histogram.total_us / 1000) << " ms total, p95 "
+		       << static_cast<int>(histogram.get_percentile(95)) << " us, max "
+		       << static_cast<int>(histogram.max_us) << " us\n";
+	}
+	return retVal;
+}
+
+bool PaintProfiler::write_report(const File &file)
+{
+	String report = "scope,name,count,total_us,mean_us,p50_us,p95_us,max_us";
+
+	for (std::size_t i = 0; i < NUMBER_OF_BUCKETS; i++)
+	{
+		report << ",bucket_" << static_cast<int>(1u << i) << "_us";
+	}
+	report << "\n";
+
+	auto addRow = [&report](const String &scope, const String &name, const Histogram &histogram) {
+		report << scope << "," << name << ","
+		       << static_cast<int>(histogram.count) << ","
+		       << static_cast<int64>(histogram.total_us) << ","
+		       << static_cast<int64>((0 != histogram.count) ? (histogram.total_us / histogram.count) : 0) << ","
+		       << static_cast<int>(histogram.get_percentile(50)) << ","
+		       << static_cast<int>(histogram.get_percentile(95)) << ","
+		       << static_cast<int>(histogram.max_us);
+
+		for (auto bucket : histogram.buckets)
+		{
+			report << "," << static_cast<int>(bucket);
+		}
+		report << "\n";
+	};
+
+	addRow("frame", "all", frames);
+
+	for (const auto &objectType : objectTypePaints)
+	{
+		addRow("object_type", get_object_type_name(objectType.first), objectType.second);
+	}
+
+	for (const auto &workingSet : workingSetPaints)
+	{
+		addRow("working_set", String::toHexString(static_cast<int64>(workingSet.first)).paddedLeft('0', 16), workingSet.second);
+	}
+	return file.replaceWithText(report);
+}
+
+void PaintProfiler::record_paint(isobus::VirtualTerminalObjectType objectType, isobus::VirtualTerminalServerManagedWorkingSet *workingSet, std::uint32_t duration_us)
+{
+	objectTypePaints[objectType].add(duration_us);
+
+	if ((nullptr != workingSet) && (nullptr != workingSet->get_control_function()))
+	{
+		workingSetPaints[workingSet->get_control_function()->get_NAME().get_full_name()].add(duration_us);
+	}
+	currentFrame_us += duration_us;
+	currentFrameHasPaints = true;
+}
+
+String PaintProfiler::get_object_type_name(isobus::VirtualTerminalObjectType objectType)
+{
+	String retVal;
+
+	switch (objectType)
+	{
+		case isobus::VirtualTerminalObjectType::WorkingSet:
+		{
+			retVal = "WorkingSet";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::DataMask:
+		{
+			retVal = "DataMask";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::AlarmMask:
+		{
+			retVal = "AlarmMask";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::Container:
+		{
+			retVal = "Container";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::SoftKeyMask:
+		{
+			retVal = "SoftKeyMask";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::Key:
+		{
+			retVal = "Key";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::Button:
+		{
+			retVal = "Button";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputBoolean:
+		{
+			retVal = "InputBoolean";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputString:
+		{
+			retVal = "InputString";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputNumber:
+		{
+			retVal = "InputNumber";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputList:
+		{
+			retVal = "InputList";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputString:
+		{
+			retVal = "OutputString";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputNumber:
+		{
+			retVal = "OutputNumber";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLine:
+		{
+			retVal = "OutputLine";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputRectangle:
+		{
+			retVal = "OutputRectangle";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputEllipse:
+		{
+			retVal = "OutputEllipse";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputPolygon:
+		{
+			retVal = "OutputPolygon";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputMeter:
+		{
+			retVal = "OutputMeter";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLinearBarGraph:
+		{
+			retVal = "OutputLinearBarGraph";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::PictureGraphic:
+		{
+			retVal = "PictureGraphic";
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::ObjectPointer:
+		{
+			retVal = "ObjectPointer";
+		}
+		break;
+
+		default:
+		{
+			retVal = "Type " + String(static_cast<int>(objectType));
+		}
+		break;
+	}
+	return retVal;
+}
@@ -0,0 +1,45 @@
+/*******************************************************************************
+** @file       PaintProfilerOverlayComponent.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "PaintProfilerOverlayComponent.hpp"
+#include "PaintProfiler.hpp"
+
+PaintProfilerOverlayComponent::PaintProfilerOverlayComponent()
+{
+	setInterceptsMouseClicks(false, false);
+	setOpaque(true); // So refreshing the summary doesn't repaint the masks underneath, which would be counted by the profiler
+}
+
+void PaintProfilerOverlayComponent::paint(Graphics &g)
+{
+	g.fillAll(Colours::black);
+	g.setColour(Colours::white);
+	g.setFont(Font(Font::getDefaultMonospacedFontName(), 12.0f, Font::FontStyleFlags::plain));
+	g.drawMultiLineText(summary, 4, 14, getWidth() - 8);
+}
+
+void PaintProfilerOverlayComponent::visibilityChanged()
+{
+	if (isVisible())
+	{
+		timerCallback();
+		startTimer(REFRESH_INTERVAL_MS);
+	}
+	else
+	{
+		stopTimer();
+	}
+}
+
+void PaintProfilerOverlayComponent::timerCallback()
+{
+	auto newSummary = PaintProfiler::get_summary(MAXIMUM_ROWS);
+
+	if (newSummary != summary)
+	{
+		summary = newSummary;
+		repaint();
+	}
+}
@@ -0,0 +1,109 @@
+//================================================================================================
+/// @file PictureDecodeKernels.cpp
+///
+/// @brief Helper functions for expanding picture graphic colour indices into packed pixels
+/// @author Adrian Del Grosso
+///
+/// @copyright 2024 Adrian Del Grosso
+//================================================================================================
+#include "PictureDecodeKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || (defined(_M_IX86) && !defined(_M_ARM64EC))
+#define PICTURE_DECODE_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(PICTURE_DECODE_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PICTURE_DECODE_KERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PICTURE_DECODE_KERNELS_TARGET_AVX2
+#endif
+
+#ifdef PICTURE_DECODE_KERNELS_X86
+/// @brief Expands the indices 16 at a time using two 8-lane gathers
+PICTURE_DECODE_KERNELS_TARGET_AVX2 static std::size_t expand_indexed_pixels_avx2(const std::uint8_t *source, std::uint32_t *destination, std::size_t pixelCount, const std::uint32_t *colourTable)
+{
+	const int *table = reinterpret_cast<const int *>(colourTable);
+	std::size_t i = 0;
+
+	for (; (i + 16) <= pixelCount; i += 16)
+	{
+		const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+		const __m256i lowIndices = _mm256_cvtepu8_epi32(indices);
+		const __m256i highIndices = _mm256_cvtepu8_epi32(_mm_srli_si128(indices, 8));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), _mm256_i32gather_epi32(table, lowIndices, 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i + 8), _mm256_i32gather_epi32(table, highIndices, 4));
+	}
+	return i;
+}
+
+static bool detect_avx2()
+{
+	bool retVal = false;
+#if defined(_MSC_VER) && !defined(__clang__)
+	int cpuInfo[4] = { 0 };
+	__cpuid(cpuInfo, 0);
+
+	if (cpuInfo[0] >= 7)
+	{
+		__cpuid(cpuInfo, 1);
+		const bool osUsesXSave = (0 != (cpuInfo[2] & (1 << 27)));
+		const bool hasAVX = (0 != (cpuInfo[2] & (1 << 28)));
+
+		if (osUsesXSave && hasAVX && (0x6 == (_xgetbv(0) & 0x6)))
+		{
+			__cpuidex(cpuInfo, 7, 0);
+			retVal = (0 != (cpuInfo[1] & (1 << 5)));
+		}
+	}
+#else
+	retVal = __builtin_cpu_supports("avx2");
+#endif
+	return retVal;
+}
+#endif
+
+bool is_vectorized_pixel_expansion_available()
+{
+#ifdef PICTURE_DECODE_KERNELS_X86
+	static const bool retVal = detect_avx2();
+#else
+	static const bool retVal = false;
+#endif
+	return retVal;
+}
+
+void expand_indexed_pixels_scalar(const std::uint8_t *source, std::uint32_t *destination, std::size_t pixelCount, const std::uint32_t *colourTable)
+{
+	std::size_t i = 0;
+
+	for (; (i + 4) <= pixelCount; i += 4)
+	{
+		destination[i] = colourTable[source[i]];
+		destination[i + 1] = colourTable[source[i + 1]];
+		destination[i + 2] = colourTable[source[i + 2]];
+		destination[i + 3] = colourTable[source[i + 3]];
+	}
+
+	for (; i < pixelCount; i++)
+	{
+		destination[i] = colourTable[source[i]];
+	}
+}
+
+void expand_indexed_pixels(const std::uint8_t *source, std::uint32_t *destination, std::size_t pixelCount, const std::uint32_t *colourTable)
+{
+	std::size_t pixelsDone = 0;
+
+#ifdef PICTURE_DECODE_KERNELS_X86
+	if (is_vectorized_pixel_expansion_available())
+	{
+		pixelsDone = expand_indexed_pixels_avx2(source, destination, pixelCount, colourTable);
+	}
+#endif
+	expand_indexed_pixels_scalar(source + pixelsDone, destination + pixelsDone, pixelCount - pixelsDone, colourTable);
+}
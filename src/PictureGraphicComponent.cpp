@@ -4,51 +4,77 @@
 ** @copyright  The Open-Agriculture Developers
 *******************************************************************************/
 #include "PictureGraphicComponent.hpp"
+#include "FlashScheduler.hpp"
+#include "PaintProfiler.hpp"
+#include "PictureDecodeKernels.hpp"
 
 PictureGraphicComponent::PictureGraphicComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::PictureGraphic sourceObject) :
   isobus::PictureGraphic(sourceObject),
   parentWorkingSet(workingSet),
-  reconstructedImage(Image::PixelFormat::ARGB, get_actual_width(), get_actual_height(), true)
+  reconstructedImage(JuceManagedWorkingSetCache::get_decoded_picture(workingSet, *this))
 {
-	generate_and_store_image();
 	setSize(PictureGraphic::get_width(), PictureGraphic::get_height());
+
+	// Transparent and flashing pictures show what's underneath, and so does the bottom of a picture with missing data
+	const bool hasAllPixels = (get_raw_data().size() >= (static_cast<std::size_t>(get_actual_width()) * get_actual_height()));
+	setOpaque((!get_option(Options::Transparent)) && (!get_option(Options::Flashing)) && hasAllPixels);
 }
 
-void PictureGraphicComponent::generate_and_store_image()
+PictureGraphicComponent::~PictureGraphicComponent()
+{
+	FlashScheduler::unsubscribe(this);
+}
+
+static_assert(sizeof(PixelARGB) == sizeof(std::uint32_t), "Packed colour table entries must be usable as 32-bit pixels");
+
+Image PictureGraphicComponent::decode_image(isobus::PictureGraphic &picture, const JuceManagedWorkingSetCache::PackedColourTable &colourTable)
 {
-	auto &rawPictureGraphicData = get_raw_data();
-	std::size_t pixelIndex = 0;
-	bool transparencyEnabled = get_option(Options::Transparent);
+	auto &rawPictureGraphicData = picture.get_raw_data();
+	auto pictureColourTable = colourTable;
+	const std::size_t imageWidth = picture.get_actual_width();
+	const std::size_t imageHeight = picture.get_actual_height();
+	Image retVal(Image::PixelFormat::ARGB, static_cast<int>(imageWidth), static_cast<int>(imageHeight), true);
 
-	for (std::uint_fast16_t i = 0; i < get_actual_height(); i++)
+	if (picture.get_option(Options::Transparent))
 	{
-		for (std::uint_fast16_t j = 0; j < get_actual_width(); j++)
+		pictureColourTable[picture.get_transparency_colour()] = PixelARGB(0, 0, 0, 0);
+	}
+
+	{
+		Image::BitmapData bitmapData(retVal, Image::BitmapData::writeOnly);
+
+		// Don't read past the end of the data if the pool gave us less than the image size
+		const std::size_t rowsToDecode = (imageWidth > 0) ? std::min(imageHeight, rawPictureGraphicData.size() / imageWidth) : 0;
+
+		for (std::size_t i = 0; i < rowsToDecode; i++)
 		{
-			auto vtColour = parentWorkingSet->get_colour(rawPictureGraphicData.at(pixelIndex));
-			if (transparencyEnabled)
-			{
-				reconstructedImage.setPixelAt(j, i, Colour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, rawPictureGraphicData.at(pixelIndex) == this->get_transparency_colour() ? 0.0f : 1.0f)));
-			}
-			else
-			{
-				reconstructedImage.setPixelAt(j, i, Colour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f)));
-			}
-			pixelIndex++;
+			auto sourceRow = rawPictureGraphicData.data() + (i * imageWidth);
+			auto destinationRow = reinterpret_cast<std::uint32_t *>(bitmapData.getLinePointer(static_cast<int>(i)));
+
+			expand_indexed_pixels(sourceRow, destinationRow, imageWidth, reinterpret_cast<const std::uint32_t *>(pictureColourTable.data()));
 		}
 	}
 
-	if ((get_actual_height() != get_height()) || (get_actual_width() != get_width()))
+	if ((picture.get_actual_height() != picture.get_height()) || (picture.get_actual_width() != picture.get_width()))
 	{
-		reconstructedImage = reconstructedImage.rescaled(get_width(), get_height());
+		retVal = retVal.rescaled(picture.get_width(), picture.get_height());
 	}
+	return retVal;
 }
 
 void PictureGraphicComponent::paint(Graphics &g)
 {
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
+	bool showImage = true;
+
 	if (!get_option(isobus::PictureGraphic::Options::Flashing))
 	{
-		stopTimer();
-		showImage = true;
+		FlashScheduler::unsubscribe(this);
+	}
+	else
+	{
+		showImage = FlashScheduler::is_shown();
 	}
 
 	if (showImage)
@@ -64,17 +90,11 @@ void PictureGraphicComponent::visibilityChanged()
 		visible = isVisible();
 		if (visible && get_option(isobus::PictureGraphic::Options::Flashing))
 		{
-			startTimer(500);
+			FlashScheduler::subscribe(this);
 		}
 		else
 		{
-			stopTimer();
+			FlashScheduler::unsubscribe(this);
 		}
 	}
 }
-
-void PictureGraphicComponent::timerCallback()
-{
-	showImage = !showImage;
-	repaint();
-}
@@ -8,7 +8,10 @@
 #include "AlarmMaskAudio.h"
 #include "JuceManagedWorkingSetCache.hpp"
 #include "Main.hpp"
+#include "PaintProfiler.hpp"
 #include "ShortcutsWindow.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include "SoftKeyMaskRenderAreaComponent.hpp"
@@ -19,10 +22,10 @@
 #include "isobus/hardware_integration/socket_can_interface.hpp"
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
-#include <iterator>
 #include <sstream>
 
 ServerMainComponent::ServerMainComponent(
@@ -35,6 +38,17 @@ ServerMainComponent::ServerMainComponent(
 	isobus::CANStackLogger::set_can_stack_logger_sink(&logger);
 	isobus::CANStackLogger::set_log_level(isobus::CANStackLogger::LoggingLevel::Info);
 
+	// Register this before the VT server so we know which objects a command changes before the server asks for a repaint
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), ObjectChangeTracker::process_rx_message, &objectChangeTracker);
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), process_pool_activity_message, this);
+
+	// Catalog the stored pools before any client can ask for them
+	storedVersionCatalog.build((File::getSpecialLocation(File::userApplicationDataDirectory).getFullPathName() +
+	                            File::getSeparatorString() +
+	                            "Open-Agriculture" +
+	                            File::getSeparatorString() +
+	                            ISO_DATA_PATH)
+	                             .toStdString());
 	VirtualTerminalServer::initialize();
 
 	logger.setVisible(true);
@@ -75,6 +89,9 @@ ServerMainComponent::ServerMainComponent(
 	addAndMakeVisible(softKeyMaskRenderer);
 	addChildComponent(loggerViewport);
 	addChildComponent(vtNumberComponent);
+#ifdef AGISOVT_PAINT_PROFILING
+	addChildComponent(paintProfilerOverlay);
+#endif
 	vtNumber = vtNumberArg;
 	menuBar.setModel(this);
 	addAndMakeVisible(menuBar);
@@ -92,7 +109,7 @@ ServerMainComponent::ServerMainComponent(
 
 	setApplicationCommandManagerToWatch(&mCommandManager);
 	mCommandManager.registerAllCommandsForTarget(this);
-	startTimer(50);
+	startTimer(BUSY_UPDATE_INTERVAL_MS);
 
 	setWantsKeyboardFocus(true);
 	addKeyListener(this);
@@ -100,6 +117,11 @@ ServerMainComponent::ServerMainComponent(
 
 ServerMainComponent::~ServerMainComponent()
 {
+	cancelPendingUpdate();
+	frameAttachment.reset();
+	isobus::CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), ObjectChangeTracker::process_rx_message, &objectChangeTracker);
+	isobus::CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), process_pool_activity_message, this);
+	JuceManagedWorkingSetCache::clear();
 }
 
 bool ServerMainComponent::get_is_enough_memory(std::uint32_t) const
@@ -114,7 +136,14 @@ isobus::VirtualTerminalBase::VTVersion ServerMainComponent::get_version() const
 
 std::uint8_t ServerMainComponent::get_number_of_navigation_soft_keys() const
 {
-	return 0;
+	std::uint8_t retVal = 0;
+
+	// The soft key area turns its last key positions into navigation keys when a mask has too many keys for one page
+	if (softKeyMaskDimensions.key_count() > SoftKeyLayout::NUMBER_OF_NAVIGATION_KEYS)
+	{
+		retVal = SoftKeyLayout::NUMBER_OF_NAVIGATION_KEYS;
+	}
+	return retVal;
 }
 
 std::uint8_t ServerMainComponent::get_soft_key_descriptor_x_pixel_width() const
@@ -247,51 +276,12 @@ bool ServerMainComponent::keyStateChanged(bool isKeyDown, Component *originating
 
 std::vector<std::array<std::uint8_t, 7>> ServerMainComponent::get_versions(isobus::NAME clientNAME)
 {
-	std::ostringstream nameString;
-	std::vector<std::array<std::uint8_t, 7>> retVal;
-	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
-	File isoDirectory(File::getSpecialLocation(File::userApplicationDataDirectory).getFullPathName().toStdString() +
-	                  File::getSeparatorString() +
-	                  "Open-Agriculture" +
-	                  File::getSeparatorString() +
-	                  ISO_DATA_PATH +
-	                  File::getSeparatorString() +
-	                  nameString.str());
-
-	if (isoDirectory.exists() && isoDirectory.isDirectory())
-	{
-		auto directoryFiles = isoDirectory.findChildFiles(File::TypesOfFileToFind::findFiles, false, "*.iopx");
+	auto retVal = storedVersionCatalog.get_version_labels(clientNAME.get_full_name());
 
-		for (auto &file : directoryFiles)
-		{
-			std::ifstream iopxFile(file.getFullPathName().toStdString(), std::ios::binary);
-
-			if (iopxFile.is_open())
-			{
-				iopxFile.unsetf(std::ios::skipws);
-				std::array<std::uint8_t, 7> versionLabel;
-				iopxFile.read(reinterpret_cast<char *>(versionLabel.data()), 7);
-
-				// Only add the version label if it is not already in the list
-				bool versionAlreadyInList = false;
-				for (const auto &version : retVal)
-				{
-					if (version == versionLabel)
-					{
-						versionAlreadyInList = true;
-						break;
-					}
-				}
-
-				if (!versionAlreadyInList)
-				{
-					retVal.push_back(versionLabel);
-				}
-			}
-		}
-	}
-	else
+	if (retVal.empty())
 	{
+		std::ostringstream nameString;
+		nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
 		isobus::CANStackLogger::info("[VT Server]: No saved object pool data for client: " + nameString.str());
 	}
 	return retVal;
@@ -305,55 +295,45 @@ std::vector<std::uint8_t> ServerMainComponent::get_supported_objects() const
 
 std::vector<std::uint8_t> ServerMainComponent::load_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
 {
+	const auto startTime = std::chrono::steady_clock::now();
 	std::ostringstream nameString;
 	std::vector<std::uint8_t> loadedIOPData;
-	std::vector<std::uint8_t> loadedVersionLabel(7);
-	std::string path = (File::getSpecialLocation(File::userApplicationDataDirectory).getFullPathName() +
-	                    File::getSeparatorString() +
-	                    "Open-Agriculture" +
-	                    File::getSeparatorString() +
-	                    ISO_DATA_PATH +
-	                    File::getSeparatorString())
-	                     .toStdString();
 	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
 
-	if ((std::filesystem::is_directory(path + nameString.str()) ||
-	     std::filesystem::exists(path + nameString.str())) &&
-	    (7 == versionLabel.size()))
+	if (7 == versionLabel.size())
 	{
-		for (const auto &entry : std::filesystem::directory_iterator(path + nameString.str()))
+		StoredVersionCatalog::VersionLabel label;
+		std::copy(versionLabel.begin(), versionLabel.end(), label.begin());
+
+		for (const auto &version : storedVersionCatalog.get_versions(clientNAME.get_full_name(), label))
 		{
-			if (entry.path().has_extension() && entry.path().extension() == ".iopx")
-			{
-				std::ifstream iopxFile(entry.path(), std::ios::binary);
+			std::ifstream iopxFile(version.path, std::ios::binary);
 
-				if (iopxFile.is_open())
-				{
-					iopxFile.unsetf(std::ios::skipws);
-					iopxFile.read(reinterpret_cast<char *>(loadedVersionLabel.data()), 7);
+			if (iopxFile.is_open() && (version.size > 7))
+			{
+				// Read the whole pool in one go, rather than one formatted extraction per byte
+				const std::size_t poolOffset = loadedIOPData.size();
+				const auto poolSize = static_cast<std::size_t>(version.size - 7);
 
-					if (7 == loadedVersionLabel.size())
-					{
-						bool versionMatches = true;
-						for (std::uint8_t i = 0; i < 7; i++)
-						{
-							if (loadedVersionLabel.at(i) != versionLabel.at(i))
-							{
-								versionMatches = false;
-								break;
-							}
-						}
+				loadedIOPData.resize(poolOffset + poolSize);
+				iopxFile.seekg(7, std::ios::beg);
+				iopxFile.read(reinterpret_cast<char *>(loadedIOPData.data() + poolOffset), static_cast<std::streamsize>(poolSize));
 
-						if (versionMatches)
-						{
-							iopxFile.seekg(7, std::ios::beg);
-							loadedIOPData.insert(loadedIOPData.end(), std::istream_iterator<std::uint8_t>(iopxFile), std::istream_iterator<std::uint8_t>());
-						}
-					}
+				if ((static_cast<std::size_t>(iopxFile.gcount()) != poolSize) ||
+				    (version.checksum != StoredVersionCatalog::calculate_checksum(loadedIOPData.data() + poolOffset, poolSize)))
+				{
+					isobus::CANStackLogger::warn("[VT Server]: Stored object pool " + version.path.string() + " has changed since it was saved, ignoring it");
+					loadedIOPData.resize(poolOffset);
 				}
 			}
 		}
 	}
+
+	if (!loadedIOPData.empty())
+	{
+		const auto loadTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+		isobus::CANStackLogger::info("[VT Server]: Loaded " + std::to_string(loadedIOPData.size()) + " bytes of stored object pool for client " + nameString.str() + " in " + std::to_string(loadTime.count()) + " us");
+	}
 	return loadedIOPData;
 }
 
@@ -383,7 +363,8 @@ bool ServerMainComponent::save_version(const std::vector<std::uint8_t> &objectPo
 		std::filesystem::create_directory(path + "/" + nameString.str()); // create src folder
 	}
 
-	std::ofstream iopxFile(path + "/" + nameString.str() + "/object_pool_with_label_" + std::to_string(number_of_iop_files_in_directory(path + "/" + nameString.str())) + ".iopx", std::ios::trunc | std::ios::binary);
+	const std::filesystem::path iopxPath(path + "/" + nameString.str() + "/object_pool_with_label_" + std::to_string(number_of_iop_files_in_directory(path + "/" + nameString.str())) + ".iopx");
+	std::ofstream iopxFile(iopxPath, std::ios::trunc | std::ios::binary);
 	std::ofstream iopFile(path + "/" + nameString.str() + "/object_pool_" + std::to_string(number_of_iop_files_in_directory(path + "/" + nameString.str())) + ".iop", std::ios::trunc | std::ios::binary);
 
 	if (iopxFile.is_open())
@@ -392,6 +373,13 @@ bool ServerMainComponent::save_version(const std::vector<std::uint8_t> &objectPo
 		iopxFile.write(reinterpret_cast<const char *>(objectPool.data()), static_cast<std::streamsize>(objectPool.size()));
 		iopxFile.close();
 		retVal = true;
+
+		if (7 == versionLabel.size())
+		{
+			StoredVersionCatalog::VersionLabel label;
+			std::copy(versionLabel.begin(), versionLabel.end(), label.begin());
+			storedVersionCatalog.add_version(clientNAME.get_full_name(), label, iopxPath, objectPool);
+		}
 	}
 	if (iopFile.is_open())
 	{
@@ -404,60 +392,21 @@ bool ServerMainComponent::save_version(const std::vector<std::uint8_t> &objectPo
 bool ServerMainComponent::delete_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
 {
 	bool retVal = false;
-	std::ostringstream nameString;
-	std::vector<std::uint8_t> loadedVersionLabel(7);
-	std::vector<std::filesystem::directory_entry> filesToRemove;
-	std::string path = (File::getSpecialLocation(File::userApplicationDataDirectory).getFullPathName() +
-	                    File::getSeparatorString() +
-	                    "Open-Agriculture" +
-	                    File::getSeparatorString() +
-	                    ISO_DATA_PATH +
-	                    File::getSeparatorString())
-	                     .toStdString();
-	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
 
-	if ((std::filesystem::is_directory(path + nameString.str()) ||
-	     std::filesystem::exists(path + nameString.str())) &&
-	    (7 == versionLabel.size()))
+	if (7 == versionLabel.size())
 	{
-		for (const auto &entry : std::filesystem::directory_iterator(path + nameString.str()))
-		{
-			if (entry.path().has_extension() && entry.path().extension() == ".iopx")
-			{
-				std::ifstream iopxFile(entry.path(), std::ios::binary);
+		StoredVersionCatalog::VersionLabel label;
+		std::copy(versionLabel.begin(), versionLabel.end(), label.begin());
+		auto versionsToRemove = storedVersionCatalog.get_versions(clientNAME.get_full_name(), label);
 
-				if (iopxFile.is_open())
-				{
-					iopxFile.unsetf(std::ios::skipws);
-					iopxFile.read(reinterpret_cast<char *>(loadedVersionLabel.data()), 7);
-
-					if (7 == loadedVersionLabel.size())
-					{
-						bool versionMatches = true;
-						for (std::uint8_t i = 0; i < 7; i++)
-						{
-							if (loadedVersionLabel.at(i) != versionLabel.at(i))
-							{
-								versionMatches = false;
-								break;
-							}
-						}
+		retVal = !versionsToRemove.empty();
 
-						if (versionMatches)
-						{
-							iopxFile.close();
-							filesToRemove.push_back(entry);
-							retVal = true;
-						}
-					}
-				}
-			}
-		}
-
-		for (const auto &entry : filesToRemove)
+		for (const auto &version : versionsToRemove)
 		{
-			retVal &= std::filesystem::remove(entry);
+			std::error_code removeError;
+			retVal &= std::filesystem::remove(version.path, removeError);
 		}
+		storedVersionCatalog.remove_version(clientNAME.get_full_name(), label);
 	}
 	return retVal;
 }
@@ -492,6 +441,7 @@ bool ServerMainComponent::delete_all_versions(isobus::NAME clientNAME)
 		{
 			retVal &= std::filesystem::remove(entry);
 		}
+		storedVersionCatalog.remove_client(clientNAME.get_full_name());
 	}
 	return retVal;
 }
@@ -514,7 +464,7 @@ bool ServerMainComponent::delete_object_pool(isobus::NAME clientNAME)
 
 void ServerMainComponent::timerCallback()
 {
-	if ((isobus::SystemTiming::time_expired_ms(statusMessageTimestamp_ms, 1000)) &&
+	if ((isobus::SystemTiming::time_expired_ms(statusMessageTimestamp_ms, STATUS_MESSAGE_INTERVAL_MS)) &&
 	    (send_status_message()))
 	{
 		statusMessageTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
@@ -527,6 +477,15 @@ void ServerMainComponent::timerCallback()
 		if (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Success == ws->get_object_pool_processing_state())
 		{
 			ws->join_parsing_thread();
+			JuceManagedWorkingSetCache::invalidate_working_set(ws);
+			JuceManagedWorkingSetCache::invalidate_colours(ws);
+			JuceManagedWorkingSetCache::predecode_pictures(ws);
+
+			ObjectChangeTracker::ChangeSet newPool;
+			newPool.fullRefreshNeeded = true;
+			newPool.coloursChanged = true;
+			dataMaskRenderer.on_objects_changed(ws, newPool);
+			request_frame(); // Pick up any changes that were recorded while the pool was loading
 
 			workingSetSelector.update_drawn_working_sets(managedWorkingSetList);
 
@@ -567,6 +526,14 @@ void ServerMainComponent::timerCallback()
 			managedWorkingSetIopLoadStateMap[ws] = false;
 			dataMaskRenderer.on_working_set_disconnect(ws);
 			softKeyMaskRenderer.on_working_set_disconnect(ws);
+			JuceManagedWorkingSetCache::remove_working_set(ws);
+			objectChangeTracker.remove_client(ws->get_control_function());
+
+			if (0 != updateRateGovernor.get_dropped_frames(ws->get_control_function()))
+			{
+				isobus::CANStackLogger::info("[VT Server]: Combined " + std::to_string(updateRateGovernor.get_dropped_frames(ws->get_control_function())) + " intermediate frames from a disconnected working set");
+			}
+			updateRateGovernor.remove_client(ws->get_control_function());
 
 			if (managedWorkingSetList.empty())
 			{
@@ -609,12 +576,6 @@ void ServerMainComponent::timerCallback()
 		}
 		else if (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Joined == ws->get_object_pool_processing_state())
 		{
-			if (dataMaskRenderer.needsRepaint() || needToRepaint)
-			{
-				needToRepaint = false;
-				repaint_data_and_soft_key_mask();
-			}
-
 			for (auto &heldButton : heldButtons)
 			{
 				if (isobus::SystemTiming::time_expired_ms(heldButton.timestamp_ms, 200))
@@ -657,6 +618,35 @@ void ServerMainComponent::timerCallback()
 	{
 		workingSetSelector.update_iop_load_indicators();
 	}
+	startTimer(get_housekeeping_interval_ms());
+}
+
+void ServerMainComponent::handleAsyncUpdate()
+{
+	if (housekeepingWakePending.exchange(false) && (BUSY_UPDATE_INTERVAL_MS != getTimerInterval()))
+	{
+		// A client started pool work, so don't wait for the next status message to notice when it finishes
+		startTimer(BUSY_UPDATE_INTERVAL_MS);
+	}
+
+	if (framePending)
+	{
+		if (nullptr == getPeer())
+		{
+			// Nothing is on screen, so there's no display refresh to wait for
+			frameAttachment.reset();
+			framePending = false;
+			update_frame();
+		}
+		else if (nullptr == frameAttachment)
+		{
+			frameAttachment = std::make_unique<VBlankAttachment>(this, [this]() { on_vblank(); });
+		}
+	}
+	else
+	{
+		frameAttachment.reset();
+	}
 }
 
 void ServerMainComponent::paint(juce::Graphics &g)
@@ -668,6 +658,14 @@ void ServerMainComponent::paint(juce::Graphics &g)
 	//workingSetSelector->paint(g);
 }
 
+void ServerMainComponent::paintOverChildren(juce::Graphics &)
+{
+#ifdef AGISOVT_PAINT_PROFILING
+	// This runs at the end of every paint of the window, after all the masks it covers
+	PaintProfiler::end_frame();
+#endif
+}
+
 void ServerMainComponent::resized()
 {
 	// This is called when the MainContentComponent is resized.
@@ -678,6 +676,9 @@ void ServerMainComponent::resized()
 
 	workingSetSelector.setBounds(0, lMenuBarHeight, WorkingSetSelectorComponent::WIDTH, minimum_height());
 	dataMaskRenderer.setBounds(WorkingSetSelectorComponent::WIDTH, lMenuBarHeight, get_data_mask_area_size_x_pixels(), get_data_mask_area_size_y_pixels());
+#ifdef AGISOVT_PAINT_PROFILING
+	paintProfilerOverlay.setBounds(dataMaskRenderer.getX(), dataMaskRenderer.getY(), std::min(dataMaskRenderer.getWidth(), 420), std::min(dataMaskRenderer.getHeight(), 150));
+#endif
 	vtNumberComponent.setBounds(dataMaskRenderer.getBounds().getX() + (dataMaskRenderer.getWidth() / 4.0),
 	                            dataMaskRenderer.getBounds().getY() + (dataMaskRenderer.getHeight() / 10.0),
 	                            dataMaskRenderer.getBounds().getWidth() / 2.0,
@@ -713,6 +714,10 @@ void ServerMainComponent::getAllCommands(juce::Array<juce::CommandID> &allComman
 	allCommands.add(static_cast<int>(CommandIDs::ClearISOData));
 	allCommands.add(static_cast<int>(CommandIDs::StartStop));
 	allCommands.add(static_cast<int>(CommandIDs::AutoStart));
+#ifdef AGISOVT_PAINT_PROFILING
+	allCommands.add(static_cast<int>(CommandIDs::TogglePaintProfilerOverlay));
+	allCommands.add(static_cast<int>(CommandIDs::SavePaintProfile));
+#endif
 #ifdef JUCE_WINDOWS
 	allCommands.add(static_cast<int>(CommandIDs::ConfigureCANHardware));
 #elif JUCE_LINUX
@@ -790,6 +795,20 @@ void ServerMainComponent::getCommandInfo(juce::CommandID commandID, ApplicationC
 		}
 		break;
 
+#ifdef AGISOVT_PAINT_PROFILING
+		case CommandIDs::TogglePaintProfilerOverlay:
+		{
+			result.setInfo("Show Paint Times", "Shows how long each kind of object takes to paint on top of the data mask", "Troubleshooting", paintProfilerOverlay.isVisible() ? ApplicationCommandInfo::CommandFlags::isTicked : 0);
+		}
+		break;
+
+		case CommandIDs::SavePaintProfile:
+		{
+			result.setInfo("Save Paint Times", "Writes paint time histograms for each kind of object and each working set to a CSV file", "Troubleshooting", 0);
+		}
+		break;
+#endif
+
 		case CommandIDs::NoCommand:
 		default:
 			break;
@@ -973,6 +992,41 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 		}
 		break;
 
+#ifdef AGISOVT_PAINT_PROFILING
+		case static_cast<int>(CommandIDs::TogglePaintProfilerOverlay):
+		{
+			paintProfilerOverlay.setVisible(!paintProfilerOverlay.isVisible());
+			mCommandManager.commandStatusChanged();
+			retVal = true;
+		}
+		break;
+
+		case static_cast<int>(CommandIDs::SavePaintProfile):
+		{
+			const File reportFile(File::getSpecialLocation(File::userApplicationDataDirectory).getFullPathName() +
+			                      File::getSeparatorString() +
+			                      "Open-Agriculture" +
+			                      File::getSeparatorString() +
+			                      "paint_times.csv");
+
+			if (reportFile.getParentDirectory().createDirectory().wasOk() && PaintProfiler::write_report(reportFile))
+			{
+				isobus::CANStackLogger::info("[VT Server]: Saved paint times to " + reportFile.getFullPathName().toStdString());
+				reportFile.revealToUser();
+			}
+			else
+			{
+				AlertWindow::showAsync(MessageBoxOptions()
+				                         .withIconType(MessageBoxIconType::WarningIcon)
+				                         .withTitle("Saving Paint Times Failed")
+				                         .withButton("OK"),
+				                       nullptr);
+			}
+			retVal = true;
+		}
+		break;
+#endif
+
 		case static_cast<int>(CommandIDs::ConfigureCANHardware):
 		{
 			configureHardwareWindow = std::make_unique<ConfigureHardwareWindow>(*this, parentCANDrivers);
@@ -1092,6 +1146,11 @@ PopupMenu ServerMainComponent::getMenuForIndex(int index, const juce::String &)
 		{
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::GenerateLogPackage));
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ClearISOData));
+#ifdef AGISOVT_PAINT_PROFILING
+			retVal.addSeparator();
+			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::TogglePaintProfilerOverlay));
+			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::SavePaintProfile));
+#endif
 		}
 		break;
 
@@ -1162,7 +1221,11 @@ void ServerMainComponent::change_selected_working_set(std::uint8_t index)
 		softKeyMaskRenderer.on_change_active_mask(ws);
 		activeWorkingSet = ws;
 		process_macro(activeWorkingSet->get_working_set_object(), isobus::EventID::OnActivate, isobus::VirtualTerminalObjectType::WorkingSet, activeWorkingSet);
-		ws->save_callback_handle(get_on_repaint_event_dispatcher().add_listener([this](std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet>) { this->repaint_on_next_update(); }));
+		ws->save_callback_handle(get_on_repaint_event_dispatcher().add_listener([this](std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> affectedWorkingSet) {
+			// The changed objects are applied on the next display refresh, which only rebuilds masks when it has to
+			objectChangeTracker.on_repaint_requested(affectedWorkingSet->get_control_function());
+			request_frame();
+		}));
 		ws->save_callback_handle(get_on_change_active_mask_event_dispatcher().add_listener([this](std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> affectedWorkingSet, std::uint16_t workingSet, std::uint16_t newMask) { this->on_change_active_mask_callback(affectedWorkingSet, workingSet, newMask); }));
 
 		if (send_status_message())
@@ -1201,6 +1264,7 @@ void ServerMainComponent::set_button_held(std::shared_ptr<isobus::VirtualTermina
 	if (!alreadyHeld)
 	{
 		heldButtons.push_back(buttonData);
+		startTimer(BUSY_UPDATE_INTERVAL_MS); // So the still held messages start on time
 	}
 }
 
@@ -1219,6 +1283,7 @@ void ServerMainComponent::set_button_released(std::shared_ptr<isobus::VirtualTer
 void ServerMainComponent::repaint_on_next_update()
 {
 	needToRepaint = true;
+	request_frame();
 }
 
 void ServerMainComponent::LanguageCommandConfigClosed::operator()(int result) const noexcept
@@ -1499,6 +1564,124 @@ void ServerMainComponent::on_change_active_mask_callback(std::shared_ptr<isobus:
 	}
 }
 
+void ServerMainComponent::process_pool_activity_message(const isobus::CANMessage &message, void *parentPointer)
+{
+	if ((nullptr != parentPointer) && (0 != message.get_data_length()))
+	{
+		switch (static_cast<isobus::VirtualTerminalBase::Function>(message.get_uint8_at(0)))
+		{
+			case isobus::VirtualTerminalBase::Function::GetMemoryMessage:
+			case isobus::VirtualTerminalBase::Function::ObjectPoolTransferMessage:
+			case isobus::VirtualTerminalBase::Function::EndOfObjectPoolMessage:
+			case isobus::VirtualTerminalBase::Function::LoadVersionCommand:
+			case isobus::VirtualTerminalBase::Function::ExtendedLoadVersionCommand:
+			{
+				auto server = static_cast<ServerMainComponent *>(parentPointer);
+				server->housekeepingWakePending = true;
+				server->triggerAsyncUpdate();
+			}
+			break;
+
+			default:
+			{
+			}
+			break;
+		}
+	}
+}
+
+void ServerMainComponent::request_frame()
+{
+	framePending = true;
+	triggerAsyncUpdate();
+}
+
+void ServerMainComponent::on_vblank()
+{
+	if (framePending.exchange(false))
+	{
+		update_frame();
+	}
+	else
+	{
+		// A whole frame went by with nothing to do, so stop waking up for every refresh
+		triggerAsyncUpdate();
+	}
+}
+
+void ServerMainComponent::update_frame()
+{
+	bool canRepaint = false;
+	bool updateDeferred = false;
+
+	for (auto &ws : managedWorkingSetList)
+	{
+		// Pools that are still being parsed are picked up by the housekeeping timer once they're done
+		if (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Joined == ws->get_object_pool_processing_state())
+		{
+			canRepaint = true;
+
+			if (objectChangeTracker.has_changes(ws->get_control_function()))
+			{
+				// The objects themselves are already up to date, so waiting only combines the changes into fewer repaints
+				if (!updateRateGovernor.try_begin_update(ws->get_control_function()))
+				{
+					updateDeferred = true;
+				}
+				else if (apply_object_changes(ws))
+				{
+					needToRepaint = true;
+				}
+			}
+		}
+	}
+
+	if (needToRepaint && canRepaint)
+	{
+		needToRepaint = false;
+		repaint_data_and_soft_key_mask();
+	}
+
+	if (updateDeferred)
+	{
+		request_frame();
+	}
+}
+
+int ServerMainComponent::get_housekeeping_interval_ms() const
+{
+	int retVal = STATUS_MESSAGE_INTERVAL_MS;
+
+	if (!heldButtons.empty())
+	{
+		retVal = BUSY_UPDATE_INTERVAL_MS;
+	}
+
+	for (auto &ws : managedWorkingSetList)
+	{
+		auto state = ws->get_object_pool_processing_state();
+
+		if (ws->is_object_pool_transfer_in_progress() ||
+		    ((isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::None != state) &&
+		     (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Joined != state)))
+		{
+			retVal = BUSY_UPDATE_INTERVAL_MS;
+		}
+	}
+
+	if (BUSY_UPDATE_INTERVAL_MS != retVal)
+	{
+		// Wake up in time for the next status message. If the last one couldn't be sent, try again after a full interval.
+		auto timeSinceStatusMessage = static_cast<int>(std::min<std::uint32_t>(isobus::SystemTiming::get_time_elapsed_ms(statusMessageTimestamp_ms), STATUS_MESSAGE_INTERVAL_MS));
+
+		if (timeSinceStatusMessage < STATUS_MESSAGE_INTERVAL_MS)
+		{
+			retVal = std::max(BUSY_UPDATE_INTERVAL_MS, STATUS_MESSAGE_INTERVAL_MS - timeSinceStatusMessage);
+		}
+	}
+	return retVal;
+}
+
 void ServerMainComponent::repaint_data_and_soft_key_mask()
 {
 	dataMaskRenderer.on_change_active_mask(activeWorkingSet);
@@ -1506,6 +1689,40 @@ void ServerMainComponent::repaint_data_and_soft_key_mask()
 	workingSetSelector.redraw();
 }
 
+bool ServerMainComponent::apply_object_changes(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	bool retVal = false;
+
+	if ((nullptr != workingSet) && (nullptr != workingSet->get_control_function()))
+	{
+		auto changes = objectChangeTracker.take_changes(workingSet->get_control_function());
+		updateRateGovernor.on_update_applied(workingSet->get_control_function(), changes.repaintRequests);
+
+		if (changes.coloursChanged)
+		{
+			JuceManagedWorkingSetCache::invalidate_colours(workingSet);
+		}
+
+		if (changes.fullRefreshNeeded)
+		{
+			JuceManagedWorkingSetCache::invalidate_working_set(workingSet);
+			retVal = true;
+		}
+		else
+		{
+			for (auto &objectID : changes.changedObjects)
+			{
+				if (!JuceManagedWorkingSetCache::update_object(workingSet, objectID))
+				{
+					retVal = true;
+				}
+			}
+		}
+		dataMaskRenderer.on_objects_changed(workingSet, changes);
+	}
+	return retVal;
+}
+
 void ServerMainComponent::check_load_settings(std::shared_ptr<ValueTree> settings)
 {
 	int index = 0;
@@ -1649,6 +1866,24 @@ void ServerMainComponent::check_load_settings(std::shared_ptr<ValueTree> setting
 				loggerViewport.setVisible(false);
 			}
 		}
+		else if (Identifier("Rendering") == child.getType())
+		{
+			if (!child.getProperty("MaxRefreshRate").isVoid())
+			{
+				updateRateGovernor.set_default_max_refresh_rate(static_cast<std::uint32_t>(std::max(0, static_cast<int>(child.getProperty("MaxRefreshRate")))));
+			}
+
+			for (auto workingSetSettings : child)
+			{
+				if ((Identifier("WorkingSet") == workingSetSettings.getType()) &&
+				    (!workingSetSettings.getProperty("NAME").isVoid()) &&
+				    (!workingSetSettings.getProperty("MaxRefreshRate").isVoid()))
+				{
+					updateRateGovernor.set_max_refresh_rate(static_cast<std::uint64_t>(workingSetSettings.getProperty("NAME").toString().getHexValue64()),
+					                                        static_cast<std::uint32_t>(std::max(0, static_cast<int>(workingSetSettings.getProperty("MaxRefreshRate")))));
+				}
+			}
+		}
 		else if (Identifier("Control") == child.getType())
 		{
 			if (!child.getProperty("AutoStart").isVoid())
@@ -1706,6 +1941,7 @@ void ServerMainComponent::save_settings()
 		ValueTree hardwareSettings("Hardware");
 		ValueTree loggingSettings("Logging");
 		ValueTree controlSettings("Control");
+		ValueTree renderingSettings("Rendering");
 
 		std::uint32_t hardwareDriverIndex = 0xFFFFFFFF;
 
@@ -1753,11 +1989,21 @@ void ServerMainComponent::save_settings()
 		loggingSettings.setProperty("Shown", static_cast<int>(logger.isVisible()), nullptr);
 		controlSettings.setProperty("AutoStart", autostart, nullptr);
 		controlSettings.setProperty("AlarmAckKey", alarmAckKeyCode, nullptr);
+		renderingSettings.setProperty("MaxRefreshRate", static_cast<int>(updateRateGovernor.get_default_max_refresh_rate()), nullptr);
+
+		for (const auto &limit : updateRateGovernor.get_max_refresh_rate_overrides())
+		{
+			ValueTree workingSetSettings("WorkingSet");
+			workingSetSettings.setProperty("NAME", String::toHexString(static_cast<int64>(limit.first)), nullptr);
+			workingSetSettings.setProperty("MaxRefreshRate", static_cast<int>(limit.second), nullptr);
+			renderingSettings.appendChild(workingSetSettings, nullptr);
+		}
 		settings.appendChild(languageCommandSettings, nullptr);
 		settings.appendChild(compatibilitySettings, nullptr);
 		settings.appendChild(hardwareSettings, nullptr);
 		settings.appendChild(loggingSettings, nullptr);
 		settings.appendChild(controlSettings, nullptr);
+		settings.appendChild(renderingSettings, nullptr);
 		std::unique_ptr<XmlElement> xml(settings.createXml());
 
 		if (nullptr != xml)
@@ -1822,6 +2068,7 @@ void ServerMainComponent::clear_iso_data()
 	if (isoDirectory.exists() && isoDirectory.isDirectory())
 	{
 		isoDirectory.deleteRecursively();
+		storedVersionCatalog.clear();
 		isobus::CANStackLogger::info("ISO Data cleared");
 	}
 }
@@ -5,9 +5,12 @@
 *******************************************************************************/
 #include "SoftKeyMaskComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 #include "SoftKeyMaskRenderAreaComponent.hpp"
 
+#include <algorithm>
+
 SoftKeyMaskComponent::SoftKeyMaskComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::SoftKeyMask sourceObject, SoftKeyMaskDimensions dimensions) :
   isobus::SoftKeyMask(sourceObject),
   parentWorkingSet(workingSet),
@@ -20,37 +23,29 @@ SoftKeyMaskComponent::SoftKeyMaskComponent(std::shared_ptr<isobus::VirtualTermin
 
 void SoftKeyMaskComponent::on_content_changed(bool initial)
 {
-	int row = 0;
-	int x = dimensionInfo.PADDING + (dimensionInfo.columnCount - 1) * (dimensionInfo.PADDING + dimensionInfo.keyWidth);
-	int y = dimensionInfo.PADDING;
+	removeAllChildren();
+	childComponents.clear();
+	layout = SoftKeyLayout(parentWorkingSet, *this, dimensionInfo);
 
-	for (std::uint16_t i = 0; i < this->get_number_children(); i++)
+	if (currentPage >= layout.get_number_of_pages())
 	{
-		auto child = get_object_by_id(get_child_id(i), parentWorkingSet->get_object_tree());
+		currentPage = 0;
+	}
 
-		if (nullptr != child)
-		{
-			childComponents.push_back(JuceManagedWorkingSetCache::create_component(parentWorkingSet, child));
+	for (const auto &slot : layout.get_slots())
+	{
+		auto child = parentWorkingSet->get_object_by_id(slot.objectID);
+		childComponents.push_back(JuceManagedWorkingSetCache::create_component(parentWorkingSet, child));
 
+		if (nullptr != childComponents.back())
+		{
 			if (isobus::VirtualTerminalObjectType::ObjectPointer == child->get_object_type())
 			{
 				childComponents.back()->setSize(dimensionInfo.keyWidth, dimensionInfo.keyHeight);
 			}
-
-			if (nullptr != childComponents.back())
-			{
-				addAndMakeVisible(*childComponents.back());
-				childComponents.back()->setTopLeftPosition(x, y);
-				y += (dimensionInfo.PADDING + dimensionInfo.keyWidth);
-
-				row++;
-				if (row >= dimensionInfo.rowCount)
-				{
-					row = 0;
-					x -= (dimensionInfo.PADDING + dimensionInfo.keyWidth);
-					y = dimensionInfo.PADDING;
-				}
-			}
+			addChildComponent(*childComponents.back());
+			childComponents.back()->setTopLeftPosition(slot.x, slot.y);
+			childComponents.back()->setVisible(slot.page == currentPage);
 		}
 	}
 
@@ -60,11 +55,41 @@ void SoftKeyMaskComponent::on_content_changed(bool initial)
 	}
 }
 
+const SoftKeyLayout &SoftKeyMaskComponent::get_layout() const
+{
+	return layout;
+}
+
+std::size_t SoftKeyMaskComponent::get_page() const
+{
+	return currentPage;
+}
+
+void SoftKeyMaskComponent::set_page(std::size_t page)
+{
+	page %= layout.get_number_of_pages();
+
+	if (page != currentPage)
+	{
+		currentPage = page;
+
+		for (std::size_t i = 0; i < childComponents.size(); i++)
+		{
+			if (nullptr != childComponents.at(i))
+			{
+				childComponents.at(i)->setVisible(layout.get_slots().at(i).page == currentPage);
+			}
+		}
+	}
+}
+
 void SoftKeyMaskComponent::paint(Graphics &g)
 {
-	auto vtColour = parentWorkingSet->get_colour(backgroundColor);
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
 
-	g.fillAll(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f));
+	auto vtColour = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, backgroundColor);
+
+	g.fillAll(vtColour);
 }
 
 int SoftKeyMaskDimensions::key_count() const
@@ -81,3 +106,115 @@ int SoftKeyMaskDimensions::total_height() const
 {
 	return PADDING + (rowCount * (keyHeight + PADDING));
 }
+
+SoftKeyLayout::SoftKeyLayout(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const isobus::SoftKeyMask &softKeyMask, const SoftKeyMaskDimensions &dimensions) :
+  dimensionInfo(dimensions)
+{
+	const std::size_t physicalKeys = static_cast<std::size_t>(std::max(1, dimensionInfo.rowCount) * std::max(1, dimensionInfo.columnCount));
+	std::vector<std::uint16_t> keyIDs;
+
+	for (std::uint16_t i = 0; i < softKeyMask.get_number_children(); i++)
+	{
+		if (nullptr != workingSet->get_object_by_id(softKeyMask.get_child_id(i)))
+		{
+			keyIDs.push_back(softKeyMask.get_child_id(i));
+		}
+	}
+
+	keysPerPage = physicalKeys;
+
+	// Navigation keys only make sense if there's still room for at least one of the mask's keys on each page
+	if ((keyIDs.size() > physicalKeys) && (physicalKeys > NUMBER_OF_NAVIGATION_KEYS))
+	{
+		keysPerPage = physicalKeys - NUMBER_OF_NAVIGATION_KEYS;
+		navigationKeys = true;
+	}
+
+	for (std::size_t i = 0; i < keyIDs.size(); i++)
+	{
+		const auto position = get_position(static_cast<int>(i % keysPerPage));
+		KeySlot slot;
+
+		slot.objectID = keyIDs.at(i);
+		slot.page = i / keysPerPage;
+		slot.x = position.getX();
+		slot.y = position.getY();
+		slots.push_back(slot);
+	}
+
+	if (!slots.empty())
+	{
+		numberOfPages = slots.back().page + 1;
+	}
+}
+
+const std::vector<SoftKeyLayout::KeySlot> &SoftKeyLayout::get_slots() const
+{
+	return slots;
+}
+
+std::size_t SoftKeyLayout::get_number_of_pages() const
+{
+	return numberOfPages;
+}
+
+const SoftKeyLayout::KeySlot *SoftKeyLayout::find_slot(int x, int y, std::size_t page) const
+{
+	const KeySlot *retVal = nullptr;
+	const int rowCount = std::max(1, dimensionInfo.rowCount);
+	const int columnCount = std::max(1, dimensionInfo.columnCount);
+	const int columnPitch = SoftKeyMaskDimensions::PADDING + dimensionInfo.keyWidth;
+	const int rowPitch = SoftKeyMaskDimensions::PADDING + dimensionInfo.keyHeight;
+	const int xInGrid = x - SoftKeyMaskDimensions::PADDING;
+	const int yInGrid = y - SoftKeyMaskDimensions::PADDING;
+
+	// Slots are on a regular grid, so the slot can be worked out directly from the position
+	if ((xInGrid >= 0) && (yInGrid >= 0) && (columnPitch > 0) && (rowPitch > 0))
+	{
+		const int column = xInGrid / columnPitch;
+		const int row = yInGrid / rowPitch;
+
+		if ((column < columnCount) &&
+		    (row < rowCount) &&
+		    ((xInGrid % columnPitch) <= dimensionInfo.keyWidth) &&
+		    ((yInGrid % rowPitch) <= dimensionInfo.keyHeight))
+		{
+			const std::size_t positionOnPage = static_cast<std::size_t>(((columnCount - 1 - column) * rowCount) + row);
+			const std::size_t slotIndex = (page * keysPerPage) + positionOnPage;
+
+			// Positions past the mask's keys on a page are the navigation keys, which aren't slots
+			if ((positionOnPage < keysPerPage) && (slotIndex < slots.size()))
+			{
+				retVal = &slots.at(slotIndex);
+			}
+		}
+	}
+	return retVal;
+}
+
+bool SoftKeyLayout::has_navigation_keys() const
+{
+	return navigationKeys;
+}
+
+Rectangle<int> SoftKeyLayout::get_navigation_key_bounds(NavigationKey key) const
+{
+	Rectangle<int> retVal;
+
+	if (navigationKeys)
+	{
+		retVal = Rectangle<int>(dimensionInfo.keyWidth, dimensionInfo.keyHeight).withPosition(get_position(static_cast<int>(keysPerPage) + static_cast<int>(key)));
+	}
+	return retVal;
+}
+
+Point<int> SoftKeyLayout::get_position(int positionOnPage) const
+{
+	const int rowCount = std::max(1, dimensionInfo.rowCount);
+	const int columnCount = std::max(1, dimensionInfo.columnCount);
+	const int column = (columnCount - 1) - (positionOnPage / rowCount);
+	const int row = positionOnPage % rowCount;
+
+	return Point<int>(SoftKeyMaskDimensions::PADDING + column * (SoftKeyMaskDimensions::PADDING + dimensionInfo.keyWidth),
+	                  SoftKeyMaskDimensions::PADDING + row * (SoftKeyMaskDimensions::PADDING + dimensionInfo.keyHeight));
+}
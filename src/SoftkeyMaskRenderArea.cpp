@@ -11,10 +11,30 @@ SoftKeyMaskRenderAreaComponent::SoftKeyMaskRenderAreaComponent(ServerMainCompone
   ownerServer(parentServer)
 {
 	//addMouseListener(this, true);
+	previousPageButton.setButtonText("<");
+	previousPageButton.onClick = [this]() {
+		auto softKeyMask = getSoftKeyMaskComponent();
+
+		if (nullptr != softKeyMask)
+		{
+			showPage(softKeyMask->get_page() + softKeyMask->get_layout().get_number_of_pages() - 1);
+		}
+	};
+	nextPageButton.onClick = [this]() {
+		auto softKeyMask = getSoftKeyMaskComponent();
+
+		if (nullptr != softKeyMask)
+		{
+			showPage(softKeyMask->get_page() + 1);
+		}
+	};
+	addChildComponent(previousPageButton);
+	addChildComponent(nextPageButton);
 }
 
 void SoftKeyMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
 {
+	removeAllChildren(); // Components are cached, so they won't remove themselves when we release them
 	childComponents.clear();
 	parentWorkingSet = workingSet;
 
@@ -51,6 +71,7 @@ void SoftKeyMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobu
 			}
 		}
 	}
+	updateNavigationKeys();
 	repaint();
 }
 
@@ -59,7 +80,9 @@ void SoftKeyMaskRenderAreaComponent::on_working_set_disconnect(std::shared_ptr<i
 	if ((nullptr != workingSet) && (workingSet == parentWorkingSet))
 	{
 		parentWorkingSet = nullptr;
+		removeAllChildren();
 		childComponents.clear();
+		updateNavigationKeys();
 		repaint();
 	}
 }
@@ -106,7 +129,7 @@ void SoftKeyMaskRenderAreaComponent::mouseDown(const MouseEvent &event)
 			}
 
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
+			auto clickedObject = getClickedKey(relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
 
 			ownerServer.process_macro(clickedObject, isobus::EventID::OnKeyPress, isobus::VirtualTerminalObjectType::Key, parentWorkingSet);
 
@@ -166,7 +189,7 @@ void SoftKeyMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 			}
 
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getPosition().x, relativeEvent.getPosition().y);
+			auto clickedObject = getClickedKey(relativeEvent.getPosition().x, relativeEvent.getPosition().y);
 
 			ownerServer.process_macro(clickedObject, isobus::EventID::OnKeyRelease, isobus::VirtualTerminalObjectType::Key, parentWorkingSet);
 
@@ -194,97 +217,89 @@ void SoftKeyMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 	}
 }
 
-std::shared_ptr<isobus::VTObject> SoftKeyMaskRenderAreaComponent::getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y)
+void SoftKeyMaskRenderAreaComponent::mouseWheelMove(const MouseEvent &, const MouseWheelDetails &wheel)
 {
-	std::shared_ptr<isobus::VTObject> retVal;
+	auto softKeyMask = getSoftKeyMaskComponent();
 
-	if ((nullptr == object) ||
-	    ((isobus::VirtualTerminalObjectType::ObjectPointer != object->get_object_type()) &&
-	     (0 == object->get_number_children())))
+	if ((nullptr != softKeyMask) && (softKeyMask->get_layout().get_number_of_pages() > 1) && (0.0f != wheel.deltaY))
 	{
-		return nullptr;
+		auto numberOfPages = softKeyMask->get_layout().get_number_of_pages();
+		showPage((wheel.deltaY < 0.0f) ? (softKeyMask->get_page() + 1) : (softKeyMask->get_page() + numberOfPages - 1));
 	}
+}
+
+void SoftKeyMaskRenderAreaComponent::showPage(std::size_t page)
+{
+	auto softKeyMask = getSoftKeyMaskComponent();
 
-	if (isobus::VirtualTerminalObjectType::ObjectPointer == object->get_object_type())
+	if (nullptr != softKeyMask)
 	{
-		auto child = object->get_object_by_id(std::static_pointer_cast<isobus::ObjectPointer>(object)->get_value(), parentWorkingSet->get_object_tree());
+		softKeyMask->set_page(page);
+		updateNavigationKeys();
+	}
+}
 
-		// Knowing the location requires some knowledge of how the mask is displaying each key...
+void SoftKeyMaskRenderAreaComponent::updateNavigationKeys()
+{
+	auto softKeyMask = getSoftKeyMaskComponent();
 
-		if ((nullptr != child) &&
-		    (objectCanBeClicked(child)) &&
-		    (isClickWithinBounds(x, y, 0, 0, ownerServer.get_soft_key_descriptor_x_pixel_width(), ownerServer.get_soft_key_descriptor_y_pixel_height())))
-		{
-			return child;
-		}
-		else if (!objectCanBeClicked(child))
-		{
-			retVal = getClickedChildRecursive(child, x, y);
-		}
+	if ((nullptr != softKeyMask) && softKeyMask->get_layout().has_navigation_keys())
+	{
+		const auto &layout = softKeyMask->get_layout();
+		const auto maskPosition = softKeyMask->getPosition();
+
+		previousPageButton.setBounds(layout.get_navigation_key_bounds(SoftKeyLayout::NavigationKey::PreviousPage) + maskPosition);
+		nextPageButton.setBounds(layout.get_navigation_key_bounds(SoftKeyLayout::NavigationKey::NextPage) + maskPosition);
+		nextPageButton.setButtonText(String(softKeyMask->get_page() + 1) + "/" + String(layout.get_number_of_pages()) + " >");
+
+		// Changing masks removes every child, and the buttons have to stay in front of the mask
+		addAndMakeVisible(previousPageButton);
+		addAndMakeVisible(nextPageButton);
+		previousPageButton.toFront(false);
+		nextPageButton.toFront(false);
 	}
 	else
 	{
-		int row = 0, col = (ownerServer.get_physical_soft_key_columns() - 1);
-		for (std::uint16_t i = 0; i < object->get_number_children(); i++)
-		{
-			auto child = object->get_object_by_id(object->get_child_id(i), parentWorkingSet->get_object_tree());
-
-			// Knowing the location requires some knowledge of how the mask is displaying each key...
+		previousPageButton.setVisible(false);
+		nextPageButton.setVisible(false);
+	}
+}
 
-			int colX = SoftKeyMaskDimensions::PADDING + col * (ownerServer.get_soft_key_descriptor_x_pixel_width() + SoftKeyMaskDimensions::PADDING);
-			int rowY = SoftKeyMaskDimensions::PADDING + row * (ownerServer.get_soft_key_descriptor_y_pixel_height() + SoftKeyMaskDimensions::PADDING);
-			if ((nullptr != child) &&
-			    (objectCanBeClicked(child)) &&
-			    (isClickWithinBounds(x, y, colX, rowY, ownerServer.get_soft_key_descriptor_x_pixel_width(), ownerServer.get_soft_key_descriptor_y_pixel_height())))
-			{
-				return child;
-			}
-			else if (!objectCanBeClicked(child))
-			{
-				retVal = getClickedChildRecursive(child, x - colX, y - rowY);
+std::shared_ptr<SoftKeyMaskComponent> SoftKeyMaskRenderAreaComponent::getSoftKeyMaskComponent() const
+{
+	std::shared_ptr<SoftKeyMaskComponent> retVal;
 
-				if (nullptr != retVal)
-				{
-					break;
-				}
-			}
-			row++;
-			if (row >= ownerServer.get_physical_soft_key_rows())
-			{
-				row = 0;
-				col--;
-			}
-		}
+	if (!childComponents.empty())
+	{
+		retVal = std::dynamic_pointer_cast<SoftKeyMaskComponent>(childComponents.back());
 	}
 	return retVal;
 }
 
-bool SoftKeyMaskRenderAreaComponent::objectCanBeClicked(std::shared_ptr<isobus::VTObject> object)
+std::shared_ptr<isobus::VTObject> SoftKeyMaskRenderAreaComponent::getClickedKey(int x, int y)
 {
-	bool retVal = false;
+	std::shared_ptr<isobus::VTObject> retVal;
+	auto softKeyMask = getSoftKeyMaskComponent();
 
-	if (nullptr != object)
+	if ((nullptr != parentWorkingSet) && (nullptr != softKeyMask))
 	{
-		switch (object->get_object_type())
+		auto slot = softKeyMask->get_layout().find_slot(x - softKeyMask->getX(), y - softKeyMask->getY(), softKeyMask->get_page());
+
+		if (nullptr != slot)
 		{
-			case isobus::VirtualTerminalObjectType::Key:
+			auto child = parentWorkingSet->get_object_by_id(slot->objectID);
+
+			// Follow object pointers to whatever key they currently point at
+			for (std::uint8_t depth = 0; (nullptr != child) && (isobus::VirtualTerminalObjectType::ObjectPointer == child->get_object_type()) && (depth < MAX_POINTER_DEPTH); depth++)
 			{
-				retVal = true;
+				child = parentWorkingSet->get_object_by_id(std::static_pointer_cast<isobus::ObjectPointer>(child)->get_value());
 			}
-			break;
 
-			default:
+			if ((nullptr != child) && (isobus::VirtualTerminalObjectType::Key == child->get_object_type()))
 			{
-				retVal = false;
+				retVal = child;
 			}
-			break;
 		}
 	}
 	return retVal;
 }
-
-bool SoftKeyMaskRenderAreaComponent::isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight)
-{
-	return ((clickXRelative >= objectX) && (clickXRelative <= (objectX + objectWidth))) &&
-	  ((clickYRelative >= objectY) && (clickYRelative <= (objectY + objectHeight)));
-}
@@ -0,0 +1,262 @@
+/*******************************************************************************
+** @file       StoredVersionCatalog.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "StoredVersionCatalog.hpp"
+
+#include "JuceHeader.h"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+void StoredVersionCatalog::build(const std::filesystem::path &isoDataDirectory)
+{
+	const std::lock_guard<std::mutex> lock(catalogMutex);
+	std::map<std::string, StoredVersion> indexedVersions;
+	std::size_t filesRead = 0;
+	std::size_t filesIndexed = 0;
+	std::error_code error;
+
+	directory = isoDataDirectory;
+	versions.clear();
+
+	auto index = XmlDocument::parse(File(String((directory / INDEX_FILE_NAME).string())));
+
+	if (nullptr != index)
+	{
+		for (auto *element : index->getChildWithTagNameIterator("Version"))
+		{
+			StoredVersion version;
+			MemoryBlock label;
+
+			label.loadFromHexString(element->getStringAttribute("Label"));
+
+			if (label.getSize() == version.label.size())
+			{
+				label.copyTo(version.label.data(), 0, version.label.size());
+				version.path = directory / element->getStringAttribute("Client").toStdString() / element->getStringAttribute("File").toStdString();
+				version.size = static_cast<std::uintmax_t>(element->getStringAttribute("Size").getLargeIntValue());
+				version.lastModified = element->getStringAttribute("Modified").getLargeIntValue();
+				version.checksum = static_cast<std::uint32_t>(element->getStringAttribute("Checksum").getHexValue32());
+				indexedVersions[version.path.string()] = version;
+			}
+		}
+	}
+
+	if (std::filesystem::is_directory(directory, error))
+	{
+		for (const auto &clientDirectory : std::filesystem::directory_iterator(directory, error))
+		{
+			const String directoryName(clientDirectory.path().filename().string());
+
+			if ((!clientDirectory.is_directory(error)) || (16 != directoryName.length()) || (!directoryName.containsOnly("0123456789abcdefABCDEF")))
+			{
+				continue;
+			}
+
+			const auto clientNAME = static_cast<std::uint64_t>(directoryName.getHexValue64());
+
+			for (const auto &entry : std::filesystem::directory_iterator(clientDirectory.path(), error))
+			{
+				if (entry.path().has_extension() && entry.path().extension() == ".iopx")
+				{
+					StoredVersion version;
+					auto indexedVersion = indexedVersions.find(entry.path().string());
+
+					if ((indexedVersions.end() != indexedVersion) &&
+					    (indexedVersion->second.size == entry.file_size(error)) &&
+					    (indexedVersion->second.lastModified == get_last_modified(entry.path())))
+					{
+						version = indexedVersion->second;
+						filesIndexed++;
+					}
+					else if (read_version_file(entry.path(), version))
+					{
+						filesRead++;
+					}
+					else
+					{
+						isobus::CANStackLogger::warn("[VT Server]: Ignoring stored object pool that could not be read: " + entry.path().string());
+						continue;
+					}
+					versions[clientNAME].push_back(version);
+				}
+			}
+		}
+
+		for (auto &client : versions)
+		{
+			// Keep the order the files were written in, since the directory order isn't defined
+			std::sort(client.second.begin(), client.second.end(), [](const StoredVersion &first, const StoredVersion &second) { return first.lastModified < second.lastModified; });
+		}
+		save_index();
+	}
+	isobus::CANStackLogger::info("[VT Server]: Catalogued " + std::to_string(filesIndexed + filesRead) + " stored object pool versions, " + std::to_string(filesRead) + " of them read from disk");
+}
+
+std::vector<StoredVersionCatalog::VersionLabel> StoredVersionCatalog::get_version_labels(std::uint64_t clientNAME) const
+{
+	const std::lock_guard<std::mutex> lock(catalogMutex);
+	std::vector<VersionLabel> retVal;
+	auto client = versions.find(clientNAME);
+
+	if (versions.end() != client)
+	{
+		for (const auto &version : client->second)
+		{
+			if (retVal.end() == std::find(retVal.begin(), retVal.end(), version.label))
+			{
+				retVal.push_back(version.label);
+			}
+		}
+	}
+	return retVal;
+}
+
+std::vector<StoredVersionCatalog::StoredVersion> StoredVersionCatalog::get_versions(std::uint64_t clientNAME, const VersionLabel &label) const
+{
+	const std::lock_guard<std::mutex> lock(catalogMutex);
+	std::vector<StoredVersion> retVal;
+	auto client = versions.find(clientNAME);
+
+	if (versions.end() != client)
+	{
+		std::copy_if(client->second.begin(), client->second.end(), std::back_inserter(retVal), [&label](const StoredVersion &version) { return version.label == label; });
+	}
+	return retVal;
+}
+
+void StoredVersionCatalog::add_version(std::uint64_t clientNAME, const VersionLabel &label, const std::filesystem::path &path, const std::vector<std::uint8_t> &objectPool)
+{
+	const std::lock_guard<std::mutex> lock(catalogMutex);
+	std::error_code error;
+	StoredVersion version;
+
+	version.label = label;
+	version.path = path;
+	version.size = std::filesystem::file_size(path, error);
+	version.lastModified = get_last_modified(path);
+	version.checksum = calculate_checksum(objectPool.data(), objectPool.size());
+
+	auto &clientVersions = versions[clientNAME];
+	clientVersions.erase(std::remove_if(clientVersions.begin(), clientVersions.end(), [&path](const StoredVersion &existing) { return existing.path == path; }), clientVersions.end());
+	clientVersions.push_back(version);
+	save_index();
+}
+
+void StoredVersionCatalog::remove_version(std::uint64_t clientNAME, const VersionLabel &label)
+{
+	const std::lock_guard<std::mutex> lock(catalogMutex);
+	auto client = versions.find(clientNAME);
+
+	if (versions.end() != client)
+	{
+		client->second.erase(std::remove_if(client->second.begin(), client->second.end(), [&label](const StoredVersion &version) { return version.label == label; }), client->second.end());
+
+		if (client->second.empty())
+		{
+			versions.erase(client);
+		}
+		save_index();
+	}
+}
+
+void StoredVersionCatalog::remove_client(std::uint64_t clientNAME)
+{
+	const std::lock_guard<std::mutex> lock(catalogMutex);
+
+	if (0 != versions.erase(clientNAME))
+	{
+		save_index();
+	}
+}
+
+void StoredVersionCatalog::clear()
+{
+	const std::lock_guard<std::mutex> lock(catalogMutex);
+	versions.clear();
+	save_index();
+}
+
+std::uint32_t StoredVersionCatalog::calculate_checksum(const std::uint8_t *data, std::size_t size)
+{
+	std::uint32_t retVal = 2166136261u;
+
+	for (std::size_t i = 0; i < size; i++)
+	{
+		retVal ^= data[i];
+		retVal *= 16777619u;
+	}
+	return retVal;
+}
+
+bool StoredVersionCatalog::read_version_file(const std::filesystem::path &path, StoredVersion &version)
+{
+	bool retVal = false;
+	std::error_code error;
+	const auto fileSize = std::filesystem::file_size(path, error);
+	std::ifstream iopxFile(path, std::ios::binary);
+
+	if ((!error) && (fileSize >= version.label.size()) && iopxFile.is_open())
+	{
+		std::vector<std::uint8_t> objectPool(static_cast<std::size_t>(fileSize - version.label.size()));
+
+		iopxFile.read(reinterpret_cast<char *>(version.label.data()), static_cast<std::streamsize>(version.label.size()));
+		iopxFile.read(reinterpret_cast<char *>(objectPool.data()), static_cast<std::streamsize>(objectPool.size()));
+
+		if (iopxFile)
+		{
+			version.path = path;
+			version.size = fileSize;
+			version.lastModified = get_last_modified(path);
+			version.checksum = calculate_checksum(objectPool.data(), objectPool.size());
+			retVal = true;
+		}
+	}
+	return retVal;
+}
+
+std::int64_t StoredVersionCatalog::get_last_modified(const std::filesystem::path &path)
+{
+	std::error_code error;
+	const auto lastModified = std::filesystem::last_write_time(path, error);
+	std::int64_t retVal = 0;
+
+	if (!error)
+	{
+		retVal = static_cast<std::int64_t>(lastModified.time_since_epoch().count());
+	}
+	return retVal;
+}
+
+void StoredVersionCatalog::save_index() const
+{
+	std::error_code error;
+
+	if (std::filesystem::is_directory(directory, error))
+	{
+		XmlElement index("StoredVersions");
+
+		for (const auto &client : versions)
+		{
+			for (const auto &version : client.second)
+			{
+				auto element = index.createNewChildElement("Version");
+				element->setAttribute("Client", String::toHexString(static_cast<int64>(client.first)).paddedLeft('0', 16));
+				element->setAttribute("File", String(version.path.filename().string()));
+				element->setAttribute("Label", String::toHexString(version.label.data(), static_cast<int>(version.label.size()), 0));
+				element->setAttribute("Size", String(static_cast<int64>(version.size)));
+				element->setAttribute("Modified", String(static_cast<int64>(version.lastModified)));
+				element->setAttribute("Checksum", String::toHexString(static_cast<int>(version.checksum)));
+			}
+		}
+
+		if (!index.writeTo(File(String((directory / INDEX_FILE_NAME).string()))))
+		{
+			isobus::CANStackLogger::warn("[VT Server]: Failed to save the stored object pool index");
+		}
+	}
+}
@@ -10,6 +10,11 @@
 
 #include <cstdint>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define STRING_ENCODING_CONVERSIONS_SSE2
+#include <emmintrin.h>
+#endif
+
 // Tables below courtesy of Tutf8e, used under MIT License
 // https://github.com/nigels-com/tutf8e
 
@@ -200,40 +205,94 @@ static void add_character(uint16_t character, std::string &output)
 	}
 }
 
-void convert_string_to_utf_8(SourceEncoding encoding, const std::string &input, std::string &output, bool autoWrappingEnabled)
+static void add_encoded_character(const uint16_t *table, unsigned char encodedChar, std::string &output, bool autoWrappingEnabled)
+{
+	uint16_t newCharacter = table[encodedChar];
+
+	if (((static_cast<std::uint8_t>(encodedChar) >= 0x7F) &&
+	     (static_cast<std::uint8_t>(encodedChar) <= 0xA0)) ||
+	    ((static_cast<std::uint8_t>(encodedChar) < 0x20) &&
+	     (0x0A != static_cast<std::uint8_t>(encodedChar)) &&
+	     (0x0D != static_cast<std::uint8_t>(encodedChar))))
+	{
+		// We ignore the character because unsupported control characters are not supposed to take
+		// up any room in the presentation of a string
+	}
+	else if (0xAD == (static_cast<std::uint8_t>(encodedChar))) // // Soft Hyphen wraps in ISO 11783
+	{
+		if (autoWrappingEnabled)
+		{
+			add_character(newCharacter, output); // The soft hyphen is drawn when wrapping on it occurs
+			add_character(table[0x0A], output); // Line feed
+		}
+		else
+		{
+			// If not wrapping, the soft hyphen is not shown
+		}
+	}
+	else
+	{
+		add_character(newCharacter, output);
+	}
+}
+
+/// @brief Returns how many bytes at the start of the data are printable ASCII (0x20 to 0x7E),
+/// which is the same in every supported encoding and in UTF-8, so can be copied as is.
+static std::size_t count_printable_ascii(const unsigned char *data, std::size_t length)
 {
-	auto table = getTable(encoding);
-	auto input_length = input.size();
-	output.reserve(input_length);
+	std::size_t retVal = 0;
+
+#ifdef STRING_ENCODING_CONVERSIONS_SSE2
+	const __m128i lowerLimit = _mm_set1_epi8(0x1F);
+	const __m128i upperLimit = _mm_set1_epi8(0x7F);
 
-	for (const unsigned char encodedChar : input)
+	// Bytes are compared as signed, so 0x80 and up are negative and fail the lower limit check
+	while ((retVal + 16) <= length)
 	{
-		uint16_t newCharacter = table[encodedChar];
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + retVal));
+		const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(bytes, lowerLimit), _mm_cmplt_epi8(bytes, upperLimit));
 
-		if (((static_cast<std::uint8_t>(encodedChar) >= 0x7F) &&
-		     (static_cast<std::uint8_t>(encodedChar) <= 0xA0)) ||
-		    ((static_cast<std::uint8_t>(encodedChar) < 0x20) &&
-		     (0x0A != static_cast<std::uint8_t>(encodedChar)) &&
-		     (0x0D != static_cast<std::uint8_t>(encodedChar))))
+		if (0xFFFF != _mm_movemask_epi8(printable))
 		{
-			// We ignore the character because unsupported control characters are not supposed to take
-			// up any room in the presentation of a string
+			break;
 		}
-		else if (0xAD == (static_cast<std::uint8_t>(encodedChar))) // // Soft Hyphen wraps in ISO 11783
+		retVal += 16;
+	}
+#endif
+
+	while ((retVal < length) && (data[retVal] >= 0x20) && (data[retVal] <= 0x7E))
+	{
+		retVal++;
+	}
+	return retVal;
+}
+
+static void append_utf_8(const uint16_t *table, const std::string &input, std::string &output, bool autoWrappingEnabled)
+{
+	const auto data = reinterpret_cast<const unsigned char *>(input.data());
+	const std::size_t inputLength = input.size();
+	std::size_t i = 0;
+
+	while (i < inputLength)
+	{
+		const std::size_t asciiRunLength = count_printable_ascii(data + i, inputLength - i);
+
+		if (0 != asciiRunLength)
 		{
-			if (autoWrappingEnabled)
-			{
-				add_character(newCharacter, output); // The soft hyphen is drawn when wrapping on it occurs
-				add_character(table[0x0A], output); // Line feed
-			}
-			else
-			{
-				// If not wrapping, the soft hyphen is not shown
-			}
+			output.append(input, i, asciiRunLength);
+			i += asciiRunLength;
 		}
-		else
+
+		if (i < inputLength)
 		{
-			add_character(newCharacter, output);
+			add_encoded_character(table, data[i], output, autoWrappingEnabled);
+			i++;
 		}
 	}
 }
+
+void convert_string_to_utf_8(SourceEncoding encoding, const std::string &input, std::string &output, bool autoWrappingEnabled)
+{
+	output.reserve(output.size() + input.size());
+	append_utf_8(getTable(encoding), input, output, autoWrappingEnabled);
+}
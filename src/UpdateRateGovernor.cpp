@@ -0,0 +1,95 @@
+/*******************************************************************************
+** @file       UpdateRateGovernor.cpp
+** @author     Adrian Del Grosso
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "UpdateRateGovernor.hpp"
+
+#include "isobus/utility/system_timing.hpp"
+
+void UpdateRateGovernor::set_default_max_refresh_rate(std::uint32_t maxRefreshRate_Hz)
+{
+	defaultMaxRefreshRate_Hz = maxRefreshRate_Hz;
+}
+
+std::uint32_t UpdateRateGovernor::get_default_max_refresh_rate() const
+{
+	return defaultMaxRefreshRate_Hz;
+}
+
+void UpdateRateGovernor::set_max_refresh_rate(std::uint64_t clientNAME, std::uint32_t maxRefreshRate_Hz)
+{
+	maxRefreshRateOverrides[clientNAME] = maxRefreshRate_Hz;
+}
+
+void UpdateRateGovernor::clear_max_refresh_rate(std::uint64_t clientNAME)
+{
+	maxRefreshRateOverrides.erase(clientNAME);
+}
+
+std::uint32_t UpdateRateGovernor::get_max_refresh_rate(std::uint64_t clientNAME) const
+{
+	std::uint32_t retVal = defaultMaxRefreshRate_Hz;
+	auto limit = maxRefreshRateOverrides.find(clientNAME);
+
+	if (maxRefreshRateOverrides.end() != limit)
+	{
+		retVal = limit->second;
+	}
+	return retVal;
+}
+
+const std::map<std::uint64_t, std::uint32_t> &UpdateRateGovernor::get_max_refresh_rate_overrides() const
+{
+	return maxRefreshRateOverrides;
+}
+
+bool UpdateRateGovernor::try_begin_update(std::shared_ptr<isobus::ControlFunction> client)
+{
+	bool retVal = true;
+
+	if (nullptr != client)
+	{
+		auto &state = clientStates[client];
+		auto maxRefreshRate_Hz = get_max_refresh_rate(client->get_NAME().get_full_name());
+
+		if ((0 != maxRefreshRate_Hz) &&
+		    state.hasUpdated &&
+		    (!isobus::SystemTiming::time_expired_ms(state.lastUpdateTimestamp_ms, 1000 / maxRefreshRate_Hz)))
+		{
+			retVal = false;
+		}
+		else
+		{
+			state.lastUpdateTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+			state.hasUpdated = true;
+		}
+	}
+	return retVal;
+}
+
+void UpdateRateGovernor::on_update_applied(std::shared_ptr<isobus::ControlFunction> client, std::uint32_t repaintRequests)
+{
+	if ((nullptr != client) && (repaintRequests > 1))
+	{
+		// Only the last of the combined requests was ever shown
+		clientStates[client].droppedFrames += (repaintRequests - 1);
+	}
+}
+
+std::uint32_t UpdateRateGovernor::get_dropped_frames(std::shared_ptr<isobus::ControlFunction> client) const
+{
+	std::uint32_t retVal = 0;
+	auto state = clientStates.find(client);
+
+	if (clientStates.end() != state)
+	{
+		retVal = state->second.droppedFrames;
+	}
+	return retVal;
+}
+
+void UpdateRateGovernor::remove_client(std::shared_ptr<isobus::ControlFunction> client)
+{
+	clientStates.erase(client);
+}
@@ -5,6 +5,7 @@
 *******************************************************************************/
 #include "WorkingSetComponent.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
+#include "PaintProfiler.hpp"
 
 WorkingSetComponent::WorkingSetComponent(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, isobus::WorkingSet sourceObject, int keyHeight, int keyWidth) :
   isobus::WorkingSet(sourceObject),
@@ -32,8 +33,9 @@ WorkingSetComponent::WorkingSetComponent(std::shared_ptr<isobus::VirtualTerminal
 
 void WorkingSetComponent::paint(Graphics &g)
 {
-	auto vtColour = parentWorkingSet->get_colour(get_background_color());
-	auto background = Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f);
+	PAINT_PROFILER_SCOPE(get_object_type(), parentWorkingSet);
+
+	auto background = JuceManagedWorkingSetCache::get_colour(parentWorkingSet, get_background_color());
 	g.setColour(background);
 	g.fillAll();
 }
@@ -18,6 +18,7 @@ WorkingSetSelectorComponent::WorkingSetSelectorComponent(ServerMainComponent &se
 
 void WorkingSetSelectorComponent::update_drawn_working_sets(std::vector<std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet>> &managedWorkingSetList)
 {
+	removeAllChildren(); // Components are cached, so they won't remove themselves when we release them
 	children.clear();
 
 	for (std::size_t i = 0; i < managedWorkingSetList.size(); i++)
@@ -68,6 +69,10 @@ void WorkingSetSelectorComponent::redraw()
 	int workingSetIndex = 0;
 	for (auto &workingSet : children)
 	{
+		for (auto &component : workingSet.childComponents)
+		{
+			removeChildComponent(component.get());
+		}
 		workingSet.childComponents.clear();
 		workingSet.childComponents.push_back(getWorkingSetChildComponent(workingSet.workingSet, workingSetIndex));
 		workingSetIndex++;